@@ -0,0 +1,136 @@
+/*
+  ** @file           : app_globalfifo_aio.c
+  ** @brief          : global fifo linux aio application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/aio_abi.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   AIO_DEPTH                   (4)
+#define   BUFFER_SIZE                 (64)
+
+
+/*
+  ** static global variable
+*/
+static char buffers[AIO_DEPTH][BUFFER_SIZE];
+
+
+/********************************************************************************************
+* Function:    aio_submit_read
+* Description: queue one asynchronous read of the fifo
+* Input:       ctx: aio context
+*              fd: globalfifo file descriptor
+*              slot: buffer index, also stored in aio_data
+* Output:      None
+* Return:      1: execute success
+*              other: execute failure
+* Others:      glibc has no wrappers for the aio syscalls, so they are called directly
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int aio_submit_read(aio_context_t ctx, int fd, int slot)
+{
+  struct iocb cb;
+  struct iocb * cbs[1] = { &cb };
+
+  memset(&cb, 0, sizeof(cb));
+  cb.aio_fildes = fd;
+  cb.aio_lio_opcode = IOCB_CMD_PREAD;
+  cb.aio_buf = (uint64_t)(uintptr_t)buffers[slot];
+  cb.aio_nbytes = BUFFER_SIZE - 1;
+  cb.aio_data = slot;
+
+  return syscall(SYS_io_submit, ctx, 1, cbs);
+}
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      keeps AIO_DEPTH reads in flight from a single thread,
+*              feed it with: echo hello > /dev/globalfifo
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+int main(int argc, char * argv[])
+{
+    int fd, i, slot;
+    aio_context_t ctx = 0;
+    struct io_event ev;
+
+    fd = open("/dev/globalfifo", O_RDONLY);
+    if (-1 == fd) {
+        log_debug("/dev/globalfifo open failure\r\n");
+        return -1;
+    }
+
+    if (syscall(SYS_io_setup, AIO_DEPTH, &ctx) < 0) {
+        perror("io_setup()");
+        return -1;
+    }
+
+    for (i = 0; i < AIO_DEPTH; i++) {
+        if (aio_submit_read(ctx, fd, i) != 1) {
+            perror("io_submit()");
+            return -1;
+        }
+    }
+
+    while (1) {
+        if (syscall(SYS_io_getevents, ctx, 1, 1, &ev, NULL) != 1)
+            continue;
+
+        slot = (int)ev.data;
+        if ((int64_t)ev.res < 0) {
+            log_debug("slot %d failed: %s\n", slot, strerror(-(int)ev.res));
+        } else {
+            buffers[slot][ev.res] = '\0';
+            log_debug("slot %d read %lld bytes: %s\n", slot, (long long)ev.res, buffers[slot]);
+        }
+
+        aio_submit_read(ctx, fd, slot);
+    }
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
@@ -0,0 +1,124 @@
+/*
+  ** @file           : app_globalfifo_splice.c
+  ** @brief          : global fifo splice application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   CHUNK_SIZE                  (4096)
+
+
+/********************************************************************************************
+* Function:    splice_send
+* Description: send a file into the fifo with sendfile()
+* Input:       fd: globalfifo file descriptor
+*              path: file to send
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      the file pages are copied straight into the ring
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int splice_send(int fd, const char * path)
+{
+  int in;
+  ssize_t len;
+  long long total = 0;
+
+  in = open(path, O_RDONLY);
+  if (-1 == in) {
+    perror("open()");
+    return -1;
+  }
+
+  while ((len = sendfile(fd, in, NULL, CHUNK_SIZE)) > 0)
+    total += len;
+
+  log_debug("sent %lld bytes\n", total);
+  close(in);
+
+  return len < 0 ? -1 : 0;
+}
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list, "w <file>" sends a file, no argument copies the fifo to stdout
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      the receiver moves fifo -> pipe -> stdout with splice(), no user buffer
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+int main(int argc, char * argv[])
+{
+    int fd, p[2];
+    ssize_t len;
+
+    fd = open("/dev/globalfifo", O_RDWR);
+    if (-1 == fd) {
+        log_debug("/dev/globalfifo open failure\r\n");
+        return -1;
+    }
+
+    if (argc > 2 && 'w' == argv[1][0])
+        return splice_send(fd, argv[2]);
+
+    if (pipe(p) < 0) {
+        perror("pipe()");
+        return -1;
+    }
+
+    while (1) {
+        len = splice(fd, NULL, p[1], NULL, CHUNK_SIZE, SPLICE_F_MOVE);
+        if (len <= 0)
+            break;
+
+        while (len > 0) {
+            ssize_t out = splice(p[0], NULL, STDOUT_FILENO, NULL, len, SPLICE_F_MOVE);
+            if (out <= 0)
+                return -1;
+            len -= out;
+        }
+    }
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
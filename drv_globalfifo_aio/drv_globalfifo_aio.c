@@ -0,0 +1,1447 @@
+/*
+  ** @file           : drv_globalfifo_aio.c
+  ** @brief          : global fifo asynchronous I/O driver source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/cdev.h>
+#include <linux/kern_levels.h>
+#include <linux/printk.h>
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/sched/signal.h>
+#include <linux/memory.h>
+#include <linux/poll.h>
+#include <linux/eventfd.h>
+#include <linux/version.h>
+#include <linux/uio.h>
+#include <linux/aio.h>
+#include <linux/workqueue.h>
+#include <linux/kthread.h>
+#include <linux/sched/mm.h>
+#include <linux/splice.h>
+
+
+/*
+  ** define
+*/
+#define     GLOBALFIFO_SIZE         (0x1000)
+#define     GLOBALFIFO_MASK         (GLOBALFIFO_SIZE - 1)
+#define     MEM_CLEAR_CMD           (0x1)
+#define     FIFO_SET_RCVLOWAT_CMD   (0x2)
+#define     FIFO_SET_SNDLOWAT_CMD   (0x3)
+#define     FIFO_SET_RD_EVENTFD_CMD (0x4)
+#define     FIFO_SET_WR_EVENTFD_CMD (0x5)
+#define     GLOBALFIFO_MAJOR        (230)
+#define     GLOBALFIFO_AIO_CLAIMED  (0)
+
+#define     log_debug(fmt, ...)     printk(KERN_DEBUG   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_info(fmt, ...)      printk(KERN_INFO    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_notice(fmt, ...)    printk(KERN_NOTICE  pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_warning(fmt, ...)   printk(KERN_WARNING pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_err(fmt, ...)       printk(KERN_ERR     pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_crit(fmt, ...)      printk(KERN_CRIT    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_alert(fmt, ...)     printk(KERN_ALERT   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_emerg(fmt, ...)     printk(KERN_EMERG   pr_fmt(fmt), ##__VA_ARGS__)
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 8, 0)
+#define     globalfifo_eventfd_signal(ctx)  eventfd_signal(ctx)
+#else
+#define     globalfifo_eventfd_signal(ctx)  eventfd_signal(ctx, 1)
+#endif
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 16, 0)
+#define     globalfifo_ki_complete(iocb, res)   (iocb)->ki_complete(iocb, res)
+#else
+#define     globalfifo_ki_complete(iocb, res)   (iocb)->ki_complete(iocb, res, 0)
+#endif
+
+/*
+  ** only fs/aio.c requests can be queued: they carry IOCB_AIO_RW and support io_cancel().
+  ** io_uring sends IOCB_NOWAIT first and then waits in poll or in an io-wq worker, which
+  ** sleeps like a plain read(). Kernels without IOCB_AIO_RW block in io_submit() instead.
+*/
+#ifdef IOCB_AIO_RW
+#define     globalfifo_aio_kiocb(iocb)      ((iocb)->ki_flags & IOCB_AIO_RW)
+#else
+#define     globalfifo_aio_kiocb(iocb)      (0)
+#endif
+
+/*
+  ** splice(2), sendfile(2) and vmsplice(2)+splice(2) reuse read_iter/write_iter: the data
+  ** is copied once between the ring and the pipe pages and never passes through user memory
+*/
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 5, 0)
+#define     globalfifo_splice_read          copy_splice_read
+#else
+#define     globalfifo_splice_read          generic_file_splice_read
+#endif
+
+
+/*
+  ** struct
+*/
+struct globalfifo_dev {
+  struct cdev cdev;
+  unsigned int current_len;
+  unsigned int head;
+  unsigned int tail;
+  unsigned char mem[GLOBALFIFO_SIZE];
+  struct mutex mutex;
+  wait_queue_head_t r_wait;
+  wait_queue_head_t w_wait;
+  struct list_head files;
+  unsigned int rcvlowat_min;
+  unsigned int sndlowat_min;
+  struct list_head rd_reqs;
+  struct list_head wr_reqs;
+};
+
+/*
+  ** per open file state, rcvlowat/sndlowat are the low watermarks of this file:
+  ** a read blocks and POLLIN stays clear until rcvlowat bytes are buffered, a write
+  ** blocks and POLLOUT stays clear until sndlowat bytes are free, SIGIO is only sent
+  ** to this file once rcvlowat bytes are buffered. rd_eventfd/wr_eventfd are signalled
+  ** under the same watermarks when data arrives or space is freed.
+  ** rd_sig_pending/wr_sig_pending mark a POLL_IN/POLL_OUT signal that was sent and not
+  ** yet acted upon, see globalfifo_notify_readers().
+*/
+struct globalfifo_file {
+  struct globalfifo_dev * dev;
+  struct list_head list;
+  fmode_t mode;
+  unsigned int rcvlowat;
+  unsigned int sndlowat;
+  struct fasync_struct * async_queue;
+  struct eventfd_ctx * rd_eventfd;
+  struct eventfd_ctx * wr_eventfd;
+  bool rd_sig_pending;
+  bool wr_sig_pending;
+};
+
+/*
+  ** queued aio read or write, see globalfifo_aio_queue(). buf holds the data between
+  ** the ring and the user buffer, iter/iov/mm describe the user buffer of a read.
+*/
+struct globalfifo_aio_req {
+  struct kiocb * iocb;
+  struct globalfifo_file * gf;
+  struct list_head list;
+  struct work_struct work;
+  unsigned long flags;
+  int dir;
+  bool done;
+  long res;
+  struct mm_struct * mm;
+  struct iov_iter iter;
+  const void * iov;
+  size_t size;
+  unsigned char buf[];
+};
+
+/*
+  ** wait queue entry of a blocked reader or writer, see globalfifo_read_wake()
+*/
+struct globalfifo_waiter {
+  wait_queue_entry_t wq;
+  struct globalfifo_file * gf;
+};
+
+
+/*
+  ** static function declaration
+*/
+static ssize_t globalfifo_read_iter(struct kiocb * iocb, struct iov_iter * to);
+static ssize_t globalfifo_write_iter(struct kiocb * iocb, struct iov_iter * from);
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig);
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg);
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait);
+static int globalfifo_open(struct inode * inode, struct file * filp);
+static int globalfifo_release(struct inode * inode, struct file *filp);
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index);
+static void globalfifo_update_lowat(struct globalfifo_dev * dev);
+static int globalfifo_read_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key);
+static int globalfifo_write_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key);
+static int globalfifo_ring_get(struct globalfifo_dev * dev, struct iov_iter * to, unsigned int size);
+static int globalfifo_ring_put(struct globalfifo_dev * dev, struct iov_iter * from, unsigned int size);
+static int globalfifo_fasync(int fd, struct file * filp, int mode);
+static void globalfifo_notify_readers(struct globalfifo_dev * dev);
+static void globalfifo_notify_writers(struct globalfifo_dev * dev);
+static int globalfifo_set_eventfd(struct globalfifo_file * gf, unsigned int cmd, int fd);
+static ssize_t globalfifo_aio_queue(struct globalfifo_file * gf, struct kiocb * iocb,
+                                    struct iov_iter * iter, int dir);
+static void globalfifo_aio_finish(struct globalfifo_aio_req * req, long res);
+static void globalfifo_aio_kick(struct globalfifo_dev * dev);
+static void globalfifo_aio_work(struct work_struct * work);
+static int globalfifo_aio_cancel(struct kiocb * iocb);
+
+
+/*
+  ** global variable
+*/
+static const struct file_operations globalfifo_fops = {
+  .owner = THIS_MODULE,
+  .llseek = globalfifo_llseek,
+  .read_iter = globalfifo_read_iter,
+  .write_iter = globalfifo_write_iter,
+  .splice_read = globalfifo_splice_read,
+  .splice_write = iter_file_splice_write,
+  .unlocked_ioctl = globalfifo_ioctl,
+  .poll = globalfifo_poll,
+  .fasync = globalfifo_fasync,
+  .open = globalfifo_open,
+  .release = globalfifo_release,
+};
+
+
+/*
+  ** static global variable
+*/
+static int globalfifo_major = GLOBALFIFO_MAJOR;
+module_param(globalfifo_major, int, S_IRUGO);
+
+struct globalfifo_dev * globalfifo_devp;
+static struct workqueue_struct * globalfifo_wq;
+
+
+/* 
+  ** static function list
+*/
+
+/********************************************************************************************
+* Function:    globalfifo_read_iter
+* Description: globalfifo read data
+* Input:       iocb: kernel I/O control block
+* Output:      to: read buffer
+* Return:      ssize_t: read data count
+*              -EIOCBQUEUED: the read was queued and completes through ki_complete
+* Others:      IOCB_NOWAIT and O_NONBLOCK return -EAGAIN instead of sleeping, so io_uring
+*              falls back to poll. An aio read that would block is queued on rd_reqs,
+*              any other read sleeps as before.
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Read from the ring head instead of shifting the buffer
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Block until the per file rcvlowat is reached
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Sleep as an exclusive waiter
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Signal the write eventfds when space is freed
+             6.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Re-arm the POLL_IN signal of the reading file
+             7.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Convert to read_iter and add IOCB_NOWAIT and aio support
+
+********************************************************************************************/
+static ssize_t globalfifo_read_iter(struct kiocb * iocb, struct iov_iter * to)
+{
+  ssize_t ret = 0;
+  bool woken = false;
+  size_t size = iov_iter_count(to);
+  struct file * filp = iocb->ki_filp;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+  struct globalfifo_waiter wait = { .gf = gf };
+  bool nowait = (iocb->ki_flags & IOCB_NOWAIT) || (filp->f_flags & O_NONBLOCK);
+
+  init_waitqueue_func_entry(&wait.wq, globalfifo_read_wake);
+  wait.wq.private = current;
+
+  if (iocb->ki_flags & IOCB_NOWAIT) {
+    if (!mutex_trylock(&dev->mutex))
+      return -EAGAIN;
+  } else {
+    mutex_lock(&dev->mutex);
+  }
+  add_wait_queue_exclusive(&dev->r_wait, &wait.wq);
+
+  while(dev->current_len < gf->rcvlowat) {
+    if (nowait) {
+      /* like SO_RCVLOWAT a non-blocking read takes whatever is there */
+      if (dev->current_len != 0)
+        break;
+
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    if (globalfifo_aio_kiocb(iocb)) {
+      ret = globalfifo_aio_queue(gf, iocb, to, READ);
+      goto out;
+    }
+
+    __set_current_state(TASK_INTERRUPTIBLE);
+    mutex_unlock(&dev->mutex);
+
+    schedule();
+    woken = true;
+    if(signal_pending(current)) {
+      /* do not swallow an exclusive wakeup meant for the next reader */
+      wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+  }
+
+  if (size > dev->current_len)
+    size = dev->current_len;
+
+  if (globalfifo_ring_get(dev, to, size)) {
+    ret = -EFAULT;
+    goto out;
+  } else {
+    log_debug("read %zu bytes(s), current_len:%d\n", size, dev->current_len);
+
+    /* this file acted on its POLL_IN, the next arrival may signal it again */
+    gf->rd_sig_pending = false;
+
+    globalfifo_aio_kick(dev);
+
+    if (GLOBALFIFO_SIZE - dev->current_len >= dev->sndlowat_min)
+      wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
+
+    /* only one reader was woken, hand the rest of the data to the next one */
+    if (woken && dev->current_len >= dev->rcvlowat_min)
+      wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
+
+    globalfifo_notify_writers(dev);
+    ret = size;
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+
+out2:
+  remove_wait_queue(&dev->r_wait, &wait.wq);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write_iter
+* Description: globalfifo write data
+* Input:       iocb: kernel I/O control block
+*              from: write buffer
+* Output:      None
+* Return:      ssize_t: written data count
+*              -EIOCBQUEUED: the write was queued and completes through ki_complete
+* Others:      mirror of globalfifo_read_iter(), a queued aio write copies its data
+*              into the request right away
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Append at the ring tail with wrap-around
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Block until the per file sndlowat is free
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Sleep as an exclusive waiter
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Notify SIGIO and eventfd listeners through globalfifo_notify_readers()
+             6.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Re-arm the POLL_OUT signal of the writing file
+             7.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Convert to write_iter and add IOCB_NOWAIT and aio support
+
+********************************************************************************************/
+static ssize_t globalfifo_write_iter(struct kiocb * iocb, struct iov_iter * from)
+{
+  ssize_t ret = 0;
+  bool woken = false;
+  size_t size = iov_iter_count(from);
+  struct file * filp = iocb->ki_filp;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+  struct globalfifo_waiter wait = { .gf = gf };
+  bool nowait = (iocb->ki_flags & IOCB_NOWAIT) || (filp->f_flags & O_NONBLOCK);
+
+  init_waitqueue_func_entry(&wait.wq, globalfifo_write_wake);
+  wait.wq.private = current;
+
+  if (iocb->ki_flags & IOCB_NOWAIT) {
+    if (!mutex_trylock(&dev->mutex))
+      return -EAGAIN;
+  } else {
+    mutex_lock(&dev->mutex);
+  }
+  add_wait_queue_exclusive(&dev->w_wait, &wait.wq);
+
+  while(GLOBALFIFO_SIZE - dev->current_len < gf->sndlowat) {
+    if (nowait) {
+      if (dev->current_len != GLOBALFIFO_SIZE)
+        break;
+
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    if (globalfifo_aio_kiocb(iocb)) {
+      ret = globalfifo_aio_queue(gf, iocb, from, WRITE);
+      goto out;
+    }
+
+    __set_current_state(TASK_INTERRUPTIBLE);
+
+    mutex_unlock(&dev->mutex);
+    schedule();
+    woken = true;
+
+    if (signal_pending(current)) {
+      wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+  }
+
+  if (size >= GLOBALFIFO_SIZE - dev->current_len)
+    size = GLOBALFIFO_SIZE - dev->current_len;
+
+  if (globalfifo_ring_put(dev, from, size)) {
+    ret = -EFAULT;
+    goto out;
+  } else {
+    log_debug("written %zu bytes(s), current_len:%d\n", size, dev->current_len);
+
+    gf->wr_sig_pending = false;
+
+    globalfifo_aio_kick(dev);
+
+    if (dev->current_len >= dev->rcvlowat_min)
+      wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
+
+    if (woken && GLOBALFIFO_SIZE - dev->current_len >= dev->sndlowat_min)
+      wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
+
+    globalfifo_notify_readers(dev);
+
+    ret = size;
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+out2:
+  remove_wait_queue(&dev->w_wait, &wait.wq);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_llseek
+* Description: globalfifo llseek pos
+* Input:       filp: struct file
+*              offset: pos offse
+*              orig: pos flag
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig)
+{
+  loff_t ret = 0;
+  switch (orig) {
+  case 0:
+    if (offset < 0) {
+      ret = -EINVAL;
+      break;
+    }
+
+    if((unsigned int)offset > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }
+
+    filp->f_pos = (unsigned int)offset;
+    ret = filp->f_pos;
+    break;
+  case 1:
+    if ((filp->f_pos + offset) > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }  
+
+    if ((filp->f_pos + offset) < 0) {
+      ret = -EINVAL;
+      break;
+    }
+    filp->f_pos += offset;
+    ret = filp->f_pos;
+    break;
+
+  default:
+    ret = -EINVAL;
+    break;
+
+  }
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ioctl
+* Description: globalfifo ioctl
+* Input:       filp: struct file
+*              cmd: command
+*              arg: argue
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_RCVLOWAT_CMD and FIFO_SET_SNDLOWAT_CMD
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_RD_EVENTFD_CMD and FIFO_SET_WR_EVENTFD_CMD
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Serve queued aio requests after a watermark change
+
+********************************************************************************************/
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg)
+{
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  switch (cmd)
+  {
+  case MEM_CLEAR_CMD:
+    memset(dev->mem, 0, GLOBALFIFO_SIZE);
+    log_debug("globalfifo is set to zero\n");
+    break;
+
+  case FIFO_SET_RCVLOWAT_CMD:
+  case FIFO_SET_SNDLOWAT_CMD:
+    /* like SO_RCVLOWAT, 0 means 1 and the watermark cannot exceed the capacity */
+    if (arg > GLOBALFIFO_SIZE)
+      return -EINVAL;
+
+    mutex_lock(&dev->mutex);
+    if (cmd == FIFO_SET_RCVLOWAT_CMD)
+      gf->rcvlowat = max_t(unsigned int, arg, 1);
+    else
+      gf->sndlowat = max_t(unsigned int, arg, 1);
+    globalfifo_update_lowat(dev);
+    globalfifo_aio_kick(dev);
+    mutex_unlock(&dev->mutex);
+
+    /* a lowered watermark may already be satisfied for any of the sleepers */
+    wake_up_interruptible_all(&dev->r_wait);
+    wake_up_interruptible_all(&dev->w_wait);
+    break;
+
+  case FIFO_SET_RD_EVENTFD_CMD:
+  case FIFO_SET_WR_EVENTFD_CMD:
+    return globalfifo_set_eventfd(gf, cmd, (int)arg);
+  
+  default:
+    return -EINVAL;
+    break;
+  }
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_poll
+* Description: globalfifo poll
+* Input:       filp: struct file
+*              poll_table: poll table pointer
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Report readiness against the per file watermarks
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Compute the mask without dev->mutex
+
+********************************************************************************************/
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait)
+{
+  unsigned int mask = 0;
+  unsigned int len;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  poll_wait(filp, &dev->r_wait, wait);
+  poll_wait(filp, &dev->w_wait, wait);
+
+  /*
+    ** no dev->mutex here: poll_wait() queued us under the wait queue lock before the
+    ** load below, and read()/write() update current_len before they take the same
+    ** lock to wake us, so either the new length is seen here or the wakeup finds us.
+    ** Every transition across a watermark issues a wakeup, which keeps EPOLLET safe.
+  */
+  len = READ_ONCE(dev->current_len);
+
+  if (len >= READ_ONCE(gf->rcvlowat)) {
+    mask |= POLLIN | POLLRDNORM;
+  }
+  
+  if (GLOBALFIFO_SIZE - len >= READ_ONCE(gf->sndlowat)) {
+    mask |= POLLOUT | POLLWRNORM;
+  }
+
+  return mask;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_fasync
+* Description: globalfifo fasync
+* Input:       fd: file descriptor 
+*              filp: struct file
+*              mode: file mode
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Keep the fasync list per open file
+
+********************************************************************************************/
+static int globalfifo_fasync(int fd, struct file * filp, int mode)
+{
+  struct globalfifo_file * gf = filp->private_data;
+
+  return fasync_helper(fd, filp, mode, &gf->async_queue);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_open
+* Description: globalfifo open
+* Input:       inode: inode 
+* Output:      filp: strcut file
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Allocate the per file state
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Set FMODE_NOWAIT
+
+********************************************************************************************/
+static int globalfifo_open(struct inode * inode, struct file * filp)
+{
+  struct globalfifo_file * gf;
+  struct globalfifo_dev * dev = globalfifo_devp;
+
+  gf = kzalloc(sizeof(struct globalfifo_file), GFP_KERNEL);
+  if (!gf)
+    return -ENOMEM;
+
+  gf->dev = dev;
+  gf->mode = filp->f_mode;
+  gf->rcvlowat = 1;
+  gf->sndlowat = 1;
+
+  mutex_lock(&dev->mutex);
+  list_add(&gf->list, &dev->files);
+  globalfifo_update_lowat(dev);
+  mutex_unlock(&dev->mutex);
+
+  /* let io_uring try IOCB_NOWAIT and poll instead of punting to a worker thread */
+  filp->f_mode |= FMODE_NOWAIT;
+  filp->private_data = gf;
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_release
+* Description: globalfifo relesase
+* Input:       inode: inode 
+*              filp: strcut file
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Free the per file state
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Drop the registered eventfds
+
+********************************************************************************************/
+static int globalfifo_release(struct inode * inode, struct file *filp)
+{
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  mutex_lock(&dev->mutex);
+  list_del(&gf->list);
+  globalfifo_update_lowat(dev);
+  mutex_unlock(&dev->mutex);
+
+  globalfifo_fasync(-1, filp, 0);
+  if (gf->rd_eventfd)
+    eventfd_ctx_put(gf->rd_eventfd);
+  if (gf->wr_eventfd)
+    eventfd_ctx_put(gf->wr_eventfd);
+  kfree(gf);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_init
+* Description: globalfifo initial
+* Input:       Noen
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Initialize the open file list
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Create the aio workqueue and request queues
+
+********************************************************************************************/
+static int __init globalfifo_init(void)
+{
+    int ret;
+
+    dev_t devno = MKDEV(globalfifo_major, 0);
+    
+    if (globalfifo_major) 
+      ret = register_chrdev_region(devno, 1, "globalfifo");
+    else {
+      ret = alloc_chrdev_region(&devno, 0, 1, "globalfifo");
+      globalfifo_major = MAJOR(devno);
+    }
+
+    if (ret < 0) 
+      return ret;
+
+    globalfifo_wq = alloc_workqueue("globalfifo_aio", 0, 0);
+    if (!globalfifo_wq) {
+      ret = -ENOMEM;
+      goto fail_wq;
+    }
+
+    globalfifo_devp = kzalloc(sizeof(struct globalfifo_dev), GFP_KERNEL);
+    if (!globalfifo_devp) {
+      ret = -ENOMEM;
+      goto fail_malloc;
+    }
+
+    globalfifo_setup_cdev(globalfifo_devp, 0);
+    mutex_init(&globalfifo_devp->mutex);
+    init_waitqueue_head(&globalfifo_devp->r_wait);
+    init_waitqueue_head(&globalfifo_devp->w_wait);
+    INIT_LIST_HEAD(&globalfifo_devp->files);
+    globalfifo_devp->rcvlowat_min = 1;
+    globalfifo_devp->sndlowat_min = 1;
+    INIT_LIST_HEAD(&globalfifo_devp->rd_reqs);
+    INIT_LIST_HEAD(&globalfifo_devp->wr_reqs);
+
+    return 0; 
+
+fail_malloc:
+    destroy_workqueue(globalfifo_wq);
+fail_wq:
+    unregister_chrdev_region(devno, 1);
+    return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_exit
+* Description: globalfifo exit
+* Input:       Noen
+* Output:      None
+* Return:      None
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Destroy the aio workqueue
+
+********************************************************************************************/
+static void __exit globalfifo_exit(void)
+{
+    cdev_del(&globalfifo_devp->cdev);
+    destroy_workqueue(globalfifo_wq);
+    kfree(globalfifo_devp);
+    unregister_chrdev_region(MKDEV(globalfifo_major, 0), 1);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_setup_cdev
+* Description: globalfifo setup cdev struct 
+* Input:       index: cdev index node
+* Output:      dev: initialed cdev 
+* Return:      None
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index)
+{
+  int err, devno = MKDEV(globalfifo_major, index);
+
+  cdev_init(&dev->cdev, &globalfifo_fops);
+  dev->cdev.owner = THIS_MODULE;
+
+  err = cdev_add(&dev->cdev, devno, 1);
+  if (err) 
+    log_debug("Error %d adding globalfifo%d", err, index);
+
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_get
+* Description: copy data out of the ring and advance the head index,
+*              the data may wrap around the end of mem[] so it is copied in two segments
+* Input:       dev: globalfifo device
+*              size: read data size, must not exceed current_len
+* Output:      to: destination iterator, user or kernel memory
+* Return:      0: execute success
+*              -EFAULT: copy failure, the ring and the iterator are left untouched
+* Others:      caller must hold dev->mutex, current_len is published with WRITE_ONCE()
+*              for the lockless readers in poll and the wake functions
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Copy to an iov_iter
+
+********************************************************************************************/
+static int globalfifo_ring_get(struct globalfifo_dev * dev, struct iov_iter * to, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->head);
+  size_t n;
+
+  n = copy_to_iter(dev->mem + dev->head, first, to);
+  if (n == first)
+    n += copy_to_iter(dev->mem, size - first, to);
+
+  if (n != size) {
+    iov_iter_revert(to, n);
+    return -EFAULT;
+  }
+
+  dev->head = (dev->head + size) & GLOBALFIFO_MASK;
+  WRITE_ONCE(dev->current_len, dev->current_len - size);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_put
+* Description: copy data into the ring and advance the tail index,
+*              the free space may wrap around the end of mem[] so it is filled in two segments
+* Input:       dev: globalfifo device
+*              from: source iterator, user or kernel memory
+*              size: write data size, must not exceed the free space
+* Output:      None
+* Return:      0: execute success
+*              -EFAULT: copy failure, the ring and the iterator are left untouched
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Copy from an iov_iter
+
+********************************************************************************************/
+static int globalfifo_ring_put(struct globalfifo_dev * dev, struct iov_iter * from, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->tail);
+  size_t n;
+
+  n = copy_from_iter(dev->mem + dev->tail, first, from);
+  if (n == first)
+    n += copy_from_iter(dev->mem, size - first, from);
+
+  if (n != size) {
+    iov_iter_revert(from, n);
+    return -EFAULT;
+  }
+
+  dev->tail = (dev->tail + size) & GLOBALFIFO_MASK;
+  WRITE_ONCE(dev->current_len, dev->current_len + size);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_update_lowat
+* Description: recompute the smallest low watermarks of the open readers and writers
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. Readers are only woken once current_len reaches
+*              rcvlowat_min and writers once the free space reaches sndlowat_min, no
+*              sleeper can be satisfied below those levels.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_update_lowat(struct globalfifo_dev * dev)
+{
+  struct globalfifo_file * gf;
+
+  dev->rcvlowat_min = GLOBALFIFO_SIZE;
+  dev->sndlowat_min = GLOBALFIFO_SIZE;
+
+  list_for_each_entry(gf, &dev->files, list) {
+    if (gf->mode & FMODE_READ)
+      dev->rcvlowat_min = min(dev->rcvlowat_min, gf->rcvlowat);
+    if (gf->mode & FMODE_WRITE)
+      dev->sndlowat_min = min(dev->sndlowat_min, gf->sndlowat);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_read_wake
+* Description: wake function of a reader sleeping on r_wait
+* Input:       wq: wait queue entry embedded in struct globalfifo_waiter
+*              mode: task state to wake
+*              sync: sync wakeup hint
+*              key: poll mask of the event
+* Output:      None
+* Return:      0: the reader cannot make progress yet and stays asleep
+*              other: the reader was woken
+* Others:      readers sleep as exclusive waiters, so a wakeup is only counted against
+*              the one-reader limit when it goes to a reader whose rcvlowat is reached
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_read_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key)
+{
+  struct globalfifo_waiter * w = container_of(wq, struct globalfifo_waiter, wq);
+
+  if (READ_ONCE(w->gf->dev->current_len) < READ_ONCE(w->gf->rcvlowat))
+    return 0;
+
+  return default_wake_function(wq, mode, sync, key);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write_wake
+* Description: wake function of a writer sleeping on w_wait
+* Input:       wq: wait queue entry embedded in struct globalfifo_waiter
+*              mode: task state to wake
+*              sync: sync wakeup hint
+*              key: poll mask of the event
+* Output:      None
+* Return:      0: the writer cannot make progress yet and stays asleep
+*              other: the writer was woken
+* Others:      mirror of globalfifo_read_wake()
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_write_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key)
+{
+  struct globalfifo_waiter * w = container_of(wq, struct globalfifo_waiter, wq);
+
+  if (GLOBALFIFO_SIZE - READ_ONCE(w->gf->dev->current_len) < READ_ONCE(w->gf->sndlowat))
+    return 0;
+
+  return default_wake_function(wq, mode, sync, key);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_notify_readers
+* Description: asynchronous notification that data arrived
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. Every open file whose rcvlowat is reached
+*              gets SIGIO if it enabled FASYNC and an eventfd count if it registered one.
+*              The signal carries POLL_IN, so with F_SETSIG send_sigio() queues the chosen
+*              real-time signal with si_fd and si_band filled in. Real-time signals queue
+*              one entry per kill, so a file is signalled once and then skipped until it
+*              reads or the fifo drops below its rcvlowat again. Writers that were told
+*              POLL_OUT are re-armed once the free space falls below their sndlowat.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Coalesce POLL_IN signals while one is pending
+
+********************************************************************************************/
+static void globalfifo_notify_readers(struct globalfifo_dev * dev)
+{
+  struct globalfifo_file * gf;
+
+  list_for_each_entry(gf, &dev->files, list) {
+    if (GLOBALFIFO_SIZE - dev->current_len < gf->sndlowat)
+      gf->wr_sig_pending = false;
+
+    if (dev->current_len < gf->rcvlowat)
+      continue;
+
+    if (gf->async_queue && !gf->rd_sig_pending) {
+      gf->rd_sig_pending = true;
+      kill_fasync(&gf->async_queue, SIGIO, POLL_IN);
+      log_debug("%s kill SIGIO\n", __func__);
+    }
+
+    if (gf->rd_eventfd)
+      globalfifo_eventfd_signal(gf->rd_eventfd);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_notify_writers
+* Description: asynchronous notification that space was freed
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. Every open file whose sndlowat is free gets
+*              a POLL_OUT signal if it enabled FASYNC and an eventfd count if it registered
+*              a write eventfd. Signals are coalesced like in globalfifo_notify_readers().
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Send POLL_OUT signals when space is freed
+
+********************************************************************************************/
+static void globalfifo_notify_writers(struct globalfifo_dev * dev)
+{
+  struct globalfifo_file * gf;
+
+  list_for_each_entry(gf, &dev->files, list) {
+    if (dev->current_len < gf->rcvlowat)
+      gf->rd_sig_pending = false;
+
+    if (GLOBALFIFO_SIZE - dev->current_len < gf->sndlowat)
+      continue;
+
+    /* only files open for writing care about free space */
+    if (gf->async_queue && (gf->mode & FMODE_WRITE) && !gf->wr_sig_pending) {
+      gf->wr_sig_pending = true;
+      kill_fasync(&gf->async_queue, SIGIO, POLL_OUT);
+      log_debug("%s kill SIGIO\n", __func__);
+    }
+
+    if (gf->wr_eventfd)
+      globalfifo_eventfd_signal(gf->wr_eventfd);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_set_eventfd
+* Description: register or drop the eventfd of an open file
+* Input:       gf: per file state
+*              cmd: FIFO_SET_RD_EVENTFD_CMD or FIFO_SET_WR_EVENTFD_CMD
+*              fd: eventfd descriptor, negative to drop the registration
+* Output:      None
+* Return:      0: execute success
+*              other: fd is not an eventfd
+* Others:      the eventfd is signalled right away when the condition already holds,
+*              so an edge-triggered event loop does not miss data queued before
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_set_eventfd(struct globalfifo_file * gf, unsigned int cmd, int fd)
+{
+  struct eventfd_ctx * ctx = NULL;
+  struct eventfd_ctx * old;
+  struct globalfifo_dev * dev = gf->dev;
+
+  if (fd >= 0) {
+    ctx = eventfd_ctx_fdget(fd);
+    if (IS_ERR(ctx))
+      return PTR_ERR(ctx);
+  }
+
+  mutex_lock(&dev->mutex);
+  if (cmd == FIFO_SET_RD_EVENTFD_CMD) {
+    old = gf->rd_eventfd;
+    gf->rd_eventfd = ctx;
+    if (ctx && dev->current_len >= gf->rcvlowat)
+      globalfifo_eventfd_signal(ctx);
+  } else {
+    old = gf->wr_eventfd;
+    gf->wr_eventfd = ctx;
+    if (ctx && GLOBALFIFO_SIZE - dev->current_len >= gf->sndlowat)
+      globalfifo_eventfd_signal(ctx);
+  }
+  mutex_unlock(&dev->mutex);
+
+  if (old)
+    eventfd_ctx_put(old);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_aio_queue
+* Description: queue an aio read or write that cannot make progress yet
+* Input:       gf: per file state
+*              iocb: aio control block
+*              iter: user buffer of the request
+*              dir: READ or WRITE
+* Output:      None
+* Return:      -EIOCBQUEUED: the request is queued
+*              other: execute failure
+* Others:      caller must hold dev->mutex. A read keeps a copy of the iterator and a
+*              reference on the submitter's mm, the data is moved into req->buf when it
+*              arrives and copied out in globalfifo_aio_work(). A write copies at most
+*              GLOBALFIFO_SIZE bytes into req->buf here, so nothing touches user memory later.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static ssize_t globalfifo_aio_queue(struct globalfifo_file * gf, struct kiocb * iocb,
+                                    struct iov_iter * iter, int dir)
+{
+  struct globalfifo_aio_req * req;
+  struct globalfifo_dev * dev = gf->dev;
+  size_t size = min_t(size_t, iov_iter_count(iter), GLOBALFIFO_SIZE);
+
+  req = kzalloc(struct_size(req, buf, size), GFP_KERNEL);
+  if (!req)
+    return -ENOMEM;
+
+  req->iocb = iocb;
+  req->gf = gf;
+  req->dir = dir;
+  req->size = size;
+  INIT_WORK(&req->work, globalfifo_aio_work);
+
+  if (dir == READ) {
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 0, 0)
+    /* a single user buffer has no segment array to duplicate */
+    if (iter_is_ubuf(iter))
+      req->iter = *iter;
+    else
+#endif
+    {
+      req->iov = dup_iter(&req->iter, iter, GFP_KERNEL);
+      if (!req->iov) {
+        kfree(req);
+        return -ENOMEM;
+      }
+    }
+
+    req->mm = current->mm;
+    mmgrab(req->mm);
+    list_add_tail(&req->list, &dev->rd_reqs);
+  } else {
+    if (copy_from_iter(req->buf, size, iter) != size) {
+      kfree(req);
+      return -EFAULT;
+    }
+
+    list_add_tail(&req->list, &dev->wr_reqs);
+  }
+
+  iocb->private = req;
+  kiocb_set_cancel_fn(iocb, globalfifo_aio_cancel);
+
+  return -EIOCBQUEUED;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_aio_finish
+* Description: take a request off its queue and hand it to the workqueue
+* Input:       req: aio request
+*              res: byte count moved or negative error
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. Whoever sets GLOBALFIFO_AIO_CLAIMED first, this
+*              function or globalfifo_aio_cancel(), queues the work, so it runs exactly once.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_aio_finish(struct globalfifo_aio_req * req, long res)
+{
+  list_del(&req->list);
+  req->res = res;
+  req->done = true;
+
+  if (!test_and_set_bit(GLOBALFIFO_AIO_CLAIMED, &req->flags))
+    queue_work(globalfifo_wq, &req->work);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_aio_kick
+* Description: serve the queued aio reads and writes
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. Called after every change of current_len or of a
+*              watermark. A served read frees space for a queued write and the other way
+*              round, so both queues are walked until neither makes progress.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_aio_kick(struct globalfifo_dev * dev)
+{
+  struct globalfifo_aio_req * req, * tmp;
+  struct iov_iter iter;
+  struct kvec kv;
+  unsigned int size;
+  bool got_data = false, got_space = false, progress;
+
+  do {
+    progress = false;
+
+    list_for_each_entry_safe(req, tmp, &dev->rd_reqs, list) {
+      if (dev->current_len < req->gf->rcvlowat)
+        continue;
+
+      size = min_t(unsigned int, req->size, dev->current_len);
+      kv.iov_base = req->buf;
+      kv.iov_len = size;
+      iov_iter_kvec(&iter, READ, &kv, 1, size);
+      globalfifo_ring_get(dev, &iter, size);
+
+      globalfifo_aio_finish(req, size);
+      got_space = progress = true;
+    }
+
+    list_for_each_entry_safe(req, tmp, &dev->wr_reqs, list) {
+      if (GLOBALFIFO_SIZE - dev->current_len < req->gf->sndlowat)
+        continue;
+
+      size = min_t(unsigned int, req->size, GLOBALFIFO_SIZE - dev->current_len);
+      kv.iov_base = req->buf;
+      kv.iov_len = size;
+      iov_iter_kvec(&iter, WRITE, &kv, 1, size);
+      globalfifo_ring_put(dev, &iter, size);
+
+      globalfifo_aio_finish(req, size);
+      got_data = progress = true;
+    }
+  } while (progress);
+
+  if (got_space) {
+    if (GLOBALFIFO_SIZE - dev->current_len >= dev->sndlowat_min)
+      wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
+    globalfifo_notify_writers(dev);
+  }
+
+  if (got_data) {
+    if (dev->current_len >= dev->rcvlowat_min)
+      wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
+    globalfifo_notify_readers(dev);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_aio_work
+* Description: complete an aio request
+* Input:       work: work item embedded in struct globalfifo_aio_req
+* Output:      None
+* Return:      None
+* Others:      runs on globalfifo_wq. A read copies req->buf to the submitter's buffer
+*              under its mm and completes with the bytes that arrived, or -EFAULT. The
+*              rest is not queued again: other reads may already have taken the data
+*              behind it, putting it back would reorder the stream. A request that was
+*              cancelled before it was served is taken off its queue and fails with -ECANCELED.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Complete a faulting read short instead of putting bytes back at the head
+
+********************************************************************************************/
+static void globalfifo_aio_work(struct work_struct * work)
+{
+  struct globalfifo_aio_req * req = container_of(work, struct globalfifo_aio_req, work);
+  struct globalfifo_dev * dev = req->gf->dev;
+  long res;
+  size_t n;
+
+  mutex_lock(&dev->mutex);
+  if (!req->done) {
+    list_del(&req->list);
+    req->res = -ECANCELED;
+  }
+  mutex_unlock(&dev->mutex);
+
+  res = req->res;
+  if (req->dir == READ && res > 0) {
+    res = -EFAULT;
+    if (mmget_not_zero(req->mm)) {
+      kthread_use_mm(req->mm);
+      n = copy_to_iter(req->buf, req->res, &req->iter);
+      kthread_unuse_mm(req->mm);
+      mmput(req->mm);
+
+      if (n)
+        res = n;
+    }
+  }
+
+  globalfifo_ki_complete(req->iocb, res);
+
+  if (req->mm)
+    mmdrop(req->mm);
+  kfree(req->iov);
+  kfree(req);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_aio_cancel
+* Description: io_cancel() callback of a queued aio request
+* Input:       iocb: aio control block
+* Output:      None
+* Return:      0: execute success
+* Others:      called under the aio context spinlock, so the request is only claimed
+*              here and taken off its queue by globalfifo_aio_work()
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_aio_cancel(struct kiocb * iocb)
+{
+  struct globalfifo_aio_req * req = iocb->private;
+
+  if (!test_and_set_bit(GLOBALFIFO_AIO_CLAIMED, &req->flags))
+    queue_work(globalfifo_wq, &req->work);
+
+  return 0;
+}
+
+
+/*
+  ** module declaration
+*/
+module_init(globalfifo_init);
+module_exit(globalfifo_exit);
+
+MODULE_AUTHOR("JexJiang");
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("A simple Hello World Module");
+MODULE_ALIAS("a simplest module");
+MODULE_VERSION("v1.0");
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
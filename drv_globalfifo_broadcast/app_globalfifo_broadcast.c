@@ -0,0 +1,92 @@
+/*
+  ** @file           : app_globalfifo_broadcast.c
+  ** @brief          : global fifo broadcast subscriber application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <stdio.h>
+#include <errno.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   FIFO_GET_LOST_CMD           (0x6)
+#define   BUFFER_SIZE                 (64)
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list, an optional delay in seconds between reads
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      start several subscribers, then feed them with: echo hello > /dev/globalfifo
+*              a subscriber started with a delay falls behind and reports the lost bytes
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+int main(int argc, char * argv[])
+{
+    int fd, delay = 0;
+    ssize_t len;
+    uint64_t lost;
+    char buf[BUFFER_SIZE];
+
+    if (argc > 1)
+        sscanf(argv[1], "%d", &delay);
+
+    fd = open("/dev/globalfifo", O_RDONLY);
+    if (-1 == fd) {
+        log_debug("/dev/globalfifo open failure\r\n");
+        return -1;
+    }
+
+    while (1) {
+        len = read(fd, buf, sizeof(buf) - 1);
+        if (len < 0 && EPIPE == errno) {
+            ioctl(fd, FIFO_GET_LOST_CMD, &lost);
+            log_debug("overrun, %llu bytes lost so far\n", (unsigned long long)lost);
+            continue;
+        } else if (len < 0) {
+            perror("read()");
+            return -1;
+        }
+
+        buf[len] = '\0';
+        log_debug("pid %d read: %s", getpid(), buf);
+
+        if (delay)
+            sleep(delay);
+    }
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
@@ -0,0 +1,129 @@
+/*
+  ** @file           : app_globalfifo_filter.c
+  ** @brief          : global fifo record filter application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   FIFO_SET_FILTER_CMD         (0x3)
+#define   FIFO_GET_FILTERED_CMD       (0x5)
+#define   GLOBALFIFO_FILTER_LEN       (16)
+#define   BUFFER_SIZE                 (64)
+
+
+/*
+  ** struct
+*/
+
+/* must match struct globalfifo_filter in drv_globalfifo_filter.c */
+struct globalfifo_filter {
+  uint32_t offset;
+  uint32_t len;
+  uint8_t value[GLOBALFIFO_FILTER_LEN];
+  uint8_t mask[GLOBALFIFO_FILTER_LEN];
+  uint32_t flags;
+  uint32_t sample;
+};
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list, "w" runs the producer, otherwise the first character is the
+*                    record type to subscribe to and an optional second argument the
+*                    sampling rate
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      the producer tags every record with one of the types A to D in its first
+*              byte, a subscriber only ever copies out the records of its type
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+int main(int argc, char * argv[])
+{
+    int fd, num = 0;
+    ssize_t len;
+    uint64_t filtered;
+    char buf[BUFFER_SIZE];
+    struct globalfifo_filter filter;
+
+    fd = open("/dev/globalfifo", O_RDWR);
+    if (-1 == fd) {
+        log_debug("/dev/globalfifo open failure\r\n");
+        return -1;
+    }
+
+    if (argc > 1 && 'w' == argv[1][0]) {
+        while (1) {
+            snprintf(buf, sizeof(buf), "%c msg %d\n", 'A' + num % 4, num);
+            num++;
+            if (write(fd, buf, strlen(buf)) < 0) {
+                perror("write()");
+                return -1;
+            }
+            usleep(100000);
+        }
+    }
+
+    /* match the type byte at offset 0 of every record */
+    memset(&filter, 0, sizeof(filter));
+    filter.len = 1;
+    filter.value[0] = argc > 1 ? argv[1][0] : 'A';
+    filter.mask[0] = 0xff;
+    filter.sample = argc > 2 ? atoi(argv[2]) : 0;
+
+    if (ioctl(fd, FIFO_SET_FILTER_CMD, &filter) < 0) {
+        perror("ioctl()");
+        return -1;
+    }
+
+    while (1) {
+        len = read(fd, buf, sizeof(buf) - 1);
+        if (len < 0) {
+            perror("read()");
+            return -1;
+        }
+
+        buf[len] = '\0';
+        ioctl(fd, FIFO_GET_FILTERED_CMD, &filtered);
+        log_debug("%llu records filtered so far, read: %s",
+                  (unsigned long long)filtered, buf);
+    }
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
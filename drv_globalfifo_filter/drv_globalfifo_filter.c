@@ -0,0 +1,1332 @@
+/*
+  ** @file           : drv_globalfifo_filter.c
+  ** @brief          : global fifo record filter driver source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/cdev.h>
+#include <linux/kern_levels.h>
+#include <linux/printk.h>
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/sched/signal.h>
+#include <linux/memory.h>
+#include <linux/poll.h>
+
+
+/*
+  ** define
+*/
+#define     GLOBALFIFO_SIZE         (0x1000)
+#define     GLOBALFIFO_MASK         (GLOBALFIFO_SIZE - 1)
+#define     MEM_CLEAR_CMD           (0x1)
+#define     FIFO_SET_BATCH_CMD      (0x2)
+#define     FIFO_SET_FILTER_CMD     (0x3)
+#define     FIFO_SET_FIFO_FILTER_CMD (0x4)
+#define     FIFO_GET_FILTERED_CMD   (0x5)
+#define     FIFO_GET_FIFO_FILTERED_CMD (0x6)
+#define     GLOBALFIFO_HDR_SIZE     (sizeof(u32))
+#define     GLOBALFIFO_REC_TAKEN    (0x80000000)
+#define     GLOBALFIFO_REC_SKIPPED  (0x40000000)
+#define     GLOBALFIFO_REC_LEN_MASK (0x3fffffff)
+#define     GLOBALFIFO_MAX_RECORD   (GLOBALFIFO_SIZE - GLOBALFIFO_HDR_SIZE)
+#define     GLOBALFIFO_FILTER_LEN   (16)
+#define     GLOBALFIFO_FILTER_SEARCH (0x1)
+#define     GLOBALFIFO_FILTER_INVERT (0x2)
+#define     GLOBALFIFO_MAJOR        (230)
+
+#define     log_debug(fmt, ...)     printk(KERN_DEBUG   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_info(fmt, ...)      printk(KERN_INFO    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_notice(fmt, ...)    printk(KERN_NOTICE  pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_warning(fmt, ...)   printk(KERN_WARNING pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_err(fmt, ...)       printk(KERN_ERR     pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_crit(fmt, ...)      printk(KERN_CRIT    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_alert(fmt, ...)     printk(KERN_ALERT   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_emerg(fmt, ...)     printk(KERN_EMERG   pr_fmt(fmt), ##__VA_ARGS__)
+
+
+/*
+  ** struct
+*/
+
+/*
+  ** record filter passed by FIFO_SET_FILTER_CMD and FIFO_SET_FIFO_FILTER_CMD, must match
+  ** struct globalfifo_filter in app_globalfifo_filter.c. A record matches when the len
+  ** payload bytes at offset equal value in every bit set in mask, with SEARCH the bytes
+  ** may sit at any offset from offset on, INVERT passes the records that do not match.
+  ** len 0 matches every record. sample then passes one of every sample matching records,
+  ** 0 and 1 pass them all.
+*/
+struct globalfifo_filter {
+  u32 offset;
+  u32 len;
+  u8 value[GLOBALFIFO_FILTER_LEN];
+  u8 mask[GLOBALFIFO_FILTER_LEN];
+  u32 flags;
+  u32 sample;
+};
+
+/*
+  ** an installed filter, seen counts the matching records for sampling and dropped
+  ** the records the filter rejected
+*/
+struct globalfifo_match {
+  struct globalfifo_filter filter;
+  bool active;
+  u32 seen;
+  u64 dropped;
+};
+
+/*
+  ** the readers share one queue, each record goes to one of them. hpos is the free-running
+  ** position of head, the read cursors of the files are kept in the same unit. A record
+  ** a reader took out of the middle of the queue is marked GLOBALFIFO_REC_TAKEN in its
+  ** length header, one a read filter rejected GLOBALFIFO_REC_SKIPPED, see
+  ** globalfifo_reclaim(). match filters the writes of every file.
+*/
+struct globalfifo_dev {
+  struct cdev cdev;
+  unsigned int current_len;
+  unsigned int head;
+  unsigned int tail;
+  unsigned int hpos;
+  unsigned char mem[GLOBALFIFO_SIZE];
+  struct mutex mutex;
+  wait_queue_head_t r_wait;
+  wait_queue_head_t w_wait;
+  struct fasync_struct * async_queue;
+  struct globalfifo_match match;
+};
+
+/*
+  ** per open file state, batch makes read() return as many whole records as fit,
+  ** each one still preceded by its u32 length. match is the read filter of this file,
+  ** cursor is where it continues to look for records, everything between head and
+  ** cursor was either taken or rejected by this filter. pass_pos is the position of
+  ** the record that already passed when passed is set, so a record that a too small
+  ** read() looked at is not sampled again.
+*/
+struct globalfifo_file {
+  struct globalfifo_dev * dev;
+  bool batch;
+  struct globalfifo_match match;
+  unsigned int cursor;
+  unsigned int pass_pos;
+  bool passed;
+};
+
+
+/*
+  ** static function declaration
+*/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos);
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos);
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig);
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg);
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait);
+static int globalfifo_open(struct inode * inode, struct file * filp);
+static int globalfifo_release(struct inode * inode, struct file *filp);
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index);
+static int globalfifo_ring_get(struct globalfifo_dev * dev, char __user * buf, unsigned int size);
+static int globalfifo_ring_put(struct globalfifo_dev * dev, const char __user * buf, unsigned int size);
+static void globalfifo_ring_peek(struct globalfifo_dev * dev, void * dst, unsigned int off, unsigned int size);
+static void globalfifo_ring_mark(struct globalfifo_dev * dev, unsigned int off, u32 flag);
+static int globalfifo_ring_copy_out(struct globalfifo_dev * dev, char __user * buf, unsigned int off, unsigned int size);
+static void globalfifo_ring_put_kernel(struct globalfifo_dev * dev, const void * src, unsigned int size);
+static ssize_t globalfifo_record_get(struct globalfifo_file * gf, char __user * buf, size_t size, unsigned int off);
+static ssize_t globalfifo_record_put(struct globalfifo_dev * dev, const char __user * buf, size_t size);
+static unsigned int globalfifo_write_room(size_t size);
+static bool globalfifo_filter_match(struct globalfifo_dev * dev, struct globalfifo_match * m, unsigned int pos, u32 len, u32 * seen);
+static bool globalfifo_filter_find(struct globalfifo_file * gf, bool commit, unsigned int * found);
+static unsigned int globalfifo_reclaim(struct globalfifo_dev * dev, bool commit);
+static int globalfifo_set_filter(struct globalfifo_match * m, const void __user * arg);
+static int globalfifo_fasync(int fd, struct file * filp, int mode);
+
+
+/*
+  ** global variable
+*/
+static const struct file_operations globalfifo_fops = {
+  .owner = THIS_MODULE,
+  .llseek = globalfifo_llseek,
+  .read = globalfifo_read,
+  .write = globalfifo_write,
+  .unlocked_ioctl = globalfifo_ioctl,
+  .poll = globalfifo_poll,
+  .fasync = globalfifo_fasync,
+  .open = globalfifo_open,
+  .release = globalfifo_release,
+};
+
+
+/*
+  ** static global variable
+*/
+static int globalfifo_major = GLOBALFIFO_MAJOR;
+module_param(globalfifo_major, int, S_IRUGO);
+
+static bool globalfifo_record = true;
+module_param(globalfifo_record, bool, S_IRUGO);
+
+struct globalfifo_dev * globalfifo_devp;
+
+
+/* 
+  ** static function list
+*/
+
+/********************************************************************************************
+* Function:    globalfifo_read
+* Description: globalfifo read data
+* Input:       filp: struct file
+*              size: read data size
+*              ppos: pos offset
+* Output:      buf: read buffer
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Read from the ring head instead of shifting the buffer
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Return whole records in record mode
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Drop the records the read filter rejects before waiting
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Skip rejected records through the cursor of the file
+
+********************************************************************************************/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos)
+{
+  ssize_t ret = 0;
+  unsigned int off = 0;
+  struct globalfifo_file *gf = filp->private_data;
+  struct globalfifo_dev *dev = gf->dev;
+
+  DECLARE_WAITQUEUE(wait, current);
+
+  mutex_lock(&dev->mutex);
+  add_wait_queue(&dev->r_wait, &wait);
+
+  /* records the filter of this file rejects are skipped here and never copied out */
+  while(!globalfifo_filter_find(gf, true, &off)) {
+    if (filp->f_flags & O_NONBLOCK) {
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    __set_current_state(TASK_INTERRUPTIBLE);
+    mutex_unlock(&dev->mutex);
+
+    schedule();
+    if(signal_pending(current)) {
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+  }
+
+  if (globalfifo_record) {
+    ret = globalfifo_record_get(gf, buf, size, off);
+    globalfifo_reclaim(dev, true);
+    goto out;
+  }
+
+  if (size > dev->current_len)
+    size = dev->current_len;
+
+  if (globalfifo_ring_get(dev, buf, size)) {
+    ret = -EFAULT;
+    goto out;
+  } else {
+    log_debug("read %d bytes(s), current_len:%d\n", size, dev->current_len);
+
+    wake_up_interruptible(&dev->w_wait);
+    ret = size;
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+
+out2:
+  remove_wait_queue(&dev->r_wait, &wait);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write
+* Description: globalfifo write data
+* Input:       filp: struct file
+*              buf: write buffer
+*              size: write data size
+*              ppos: pos offset
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Append at the ring tail with wrap-around
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Queue each write as one length-prefixed record in record mode
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Report records the fifo filter rejects as written
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Reclaim the taken and skipped records before waiting for room
+
+********************************************************************************************/
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos)
+{
+  ssize_t ret = 0;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+  unsigned int room = globalfifo_write_room(size);
+
+  DECLARE_WAITQUEUE(wait, current);
+
+  if (globalfifo_record) {
+    if (size == 0)
+      return 0;
+
+    if (size > GLOBALFIFO_MAX_RECORD)
+      return -EMSGSIZE;
+  }
+
+  mutex_lock(&dev->mutex);
+  add_wait_queue(&dev->w_wait, &wait);
+
+  /* this writer is on w_wait, so the records a reader skipped may go */
+  globalfifo_reclaim(dev, true);
+
+  while(GLOBALFIFO_SIZE - dev->current_len < room) {
+    if (filp->f_flags & O_NONBLOCK) {
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    __set_current_state(TASK_INTERRUPTIBLE);
+
+    mutex_unlock(&dev->mutex);
+    schedule();
+
+    if (signal_pending(current)) {
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+    globalfifo_reclaim(dev, true);
+  }
+
+  if (globalfifo_record) {
+    ret = globalfifo_record_put(dev, buf, size);
+
+    /* the fifo filter rejected the record, to the writer it still went out whole */
+    if (ret == -ENODATA) {
+      ret = size;
+      goto out;
+    }
+  } else {
+    if (size >= GLOBALFIFO_SIZE - dev->current_len)
+      size = GLOBALFIFO_SIZE - dev->current_len;
+
+    ret = globalfifo_ring_put(dev, buf, size) ? -EFAULT : size;
+  }
+
+  if (ret < 0)
+    goto out;
+
+  log_debug("written %zd bytes(s), current_len:%d\n", ret, dev->current_len);
+
+  wake_up_interruptible(&dev->r_wait);
+
+  if (dev->async_queue) {
+    kill_fasync(&dev->async_queue, SIGIO, POLL_IN);
+    log_debug("%s kill SIGIO\n", __func__);
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+out2:
+  remove_wait_queue(&dev->w_wait, &wait);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_llseek
+* Description: globalfifo llseek pos
+* Input:       filp: struct file
+*              offset: pos offse
+*              orig: pos flag
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig)
+{
+  loff_t ret = 0;
+  switch (orig) {
+  case 0:
+    if (offset < 0) {
+      ret = -EINVAL;
+      break;
+    }
+
+    if((unsigned int)offset > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }
+
+    filp->f_pos = (unsigned int)offset;
+    ret = filp->f_pos;
+    break;
+  case 1:
+    if ((filp->f_pos + offset) > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }  
+
+    if ((filp->f_pos + offset) < 0) {
+      ret = -EINVAL;
+      break;
+    }
+    filp->f_pos += offset;
+    ret = filp->f_pos;
+    break;
+
+  default:
+    ret = -EINVAL;
+    break;
+
+  }
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ioctl
+* Description: globalfifo ioctl
+* Input:       filp: struct file
+*              cmd: command
+*              arg: argue
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Drop all records on MEM_CLEAR_CMD, add FIFO_SET_BATCH_CMD
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_FILTER_CMD, FIFO_SET_FIFO_FILTER_CMD and the filtered counters
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Rewind the cursor of the file when its filter changes
+
+********************************************************************************************/
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg)
+{
+  int ret;
+  u64 dropped;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  switch (cmd)
+  {
+  case MEM_CLEAR_CMD:
+    /* zeroing the buffer alone would turn the queued length headers into garbage */
+    mutex_lock(&dev->mutex);
+    memset(dev->mem, 0, GLOBALFIFO_SIZE);
+    dev->hpos += dev->current_len;
+    dev->head = 0;
+    dev->tail = 0;
+    dev->current_len = 0;
+    mutex_unlock(&dev->mutex);
+
+    wake_up_interruptible(&dev->w_wait);
+    log_debug("globalfifo is set to zero\n");
+    break;
+
+  case FIFO_SET_BATCH_CMD:
+    gf->batch = !!arg;
+    break;
+
+  case FIFO_SET_FILTER_CMD:
+  case FIFO_SET_FIFO_FILTER_CMD:
+    /* filters work on records, a byte stream has nothing to match against */
+    if (!globalfifo_record)
+      return -EINVAL;
+
+    mutex_lock(&dev->mutex);
+    if (cmd == FIFO_SET_FILTER_CMD) {
+      ret = globalfifo_set_filter(&gf->match, (const void __user *)arg);
+      /* what the old filter skipped is looked at again */
+      gf->cursor = dev->hpos;
+      gf->passed = false;
+    } else {
+      ret = globalfifo_set_filter(&dev->match, (const void __user *)arg);
+    }
+    mutex_unlock(&dev->mutex);
+
+    /* records the old read filter held back may pass now, poll() decides again */
+    wake_up_interruptible(&dev->r_wait);
+    return ret;
+
+  case FIFO_GET_FILTERED_CMD:
+  case FIFO_GET_FIFO_FILTERED_CMD:
+    mutex_lock(&dev->mutex);
+    dropped = cmd == FIFO_GET_FILTERED_CMD ? gf->match.dropped : dev->match.dropped;
+    mutex_unlock(&dev->mutex);
+
+    return put_user(dropped, (u64 __user *)arg);
+  
+  default:
+    return -EINVAL;
+    break;
+  }
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_poll
+* Description: globalfifo poll
+* Input:       filp: struct file
+*              poll_table: poll table pointer
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Report POLLOUT only when at least a one byte record fits
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Report POLLIN only for records the read filter passes
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Look for a passing record without skipping, count reclaimable room as free
+
+********************************************************************************************/
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait)
+{
+  unsigned int mask = 0, off;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  mutex_lock(&dev->mutex);
+  
+  poll_wait(filp, &dev->r_wait, wait);
+  poll_wait(filp, &dev->w_wait, wait);
+
+  /* readable only once a record passes the filter of this file, nothing is skipped here */
+  if (globalfifo_filter_find(gf, false, &off)) {
+    mask |= POLLIN | POLLRDNORM;
+  }
+  
+  /* a write may drop the records every reader skipped, count them as free */
+  if (GLOBALFIFO_SIZE - dev->current_len + globalfifo_reclaim(dev, false) >= globalfifo_write_room(1)) {
+    mask |= POLLOUT | POLLWRNORM;
+  }
+
+  mutex_unlock(&dev->mutex);
+
+  return mask;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_fasync
+* Description: globalfifo fasync
+* Input:       fd: file descriptor 
+*              filp: struct file
+*              mode: file mode
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_fasync(int fd, struct file * filp, int mode)
+{
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  return fasync_helper(fd, filp, mode, &dev->async_queue);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_open
+* Description: globalfifo open
+* Input:       inode: inode 
+* Output:      filp: strcut file
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Allocate the per file state
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Start the cursor of the file at head
+
+********************************************************************************************/
+static int globalfifo_open(struct inode * inode, struct file * filp)
+{
+  struct globalfifo_file * gf;
+
+  gf = kzalloc(sizeof(struct globalfifo_file), GFP_KERNEL);
+  if (!gf)
+    return -ENOMEM;
+
+  gf->dev = globalfifo_devp;
+
+  mutex_lock(&gf->dev->mutex);
+  gf->cursor = gf->dev->hpos;
+  mutex_unlock(&gf->dev->mutex);
+
+  filp->private_data = gf;
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_release
+* Description: globalfifo relesase
+* Input:       inode: inode 
+*              filp: strcut file
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Free the per file state
+
+********************************************************************************************/
+static int globalfifo_release(struct inode * inode, struct file *filp)
+{
+  globalfifo_fasync(-1, filp, 0);
+  kfree(filp->private_data);
+  
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_init
+* Description: globalfifo initial
+* Input:       Noen
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int __init globalfifo_init(void)
+{
+    int ret;
+
+    dev_t devno = MKDEV(globalfifo_major, 0);
+    
+    if (globalfifo_major) 
+      ret = register_chrdev_region(devno, 1, "globalfifo");
+    else {
+      ret = alloc_chrdev_region(&devno, 0, 1, "globalfifo");
+      globalfifo_major = MAJOR(devno);
+    }
+
+    if (ret < 0) 
+      return ret;
+
+    globalfifo_devp = kzalloc(sizeof(struct globalfifo_dev), GFP_KERNEL);
+    if (!globalfifo_devp) {
+      ret = -ENOMEM;
+      goto fail_malloc;
+    }
+
+    globalfifo_setup_cdev(globalfifo_devp, 0);
+    mutex_init(&globalfifo_devp->mutex);
+    init_waitqueue_head(&globalfifo_devp->r_wait);
+    init_waitqueue_head(&globalfifo_devp->w_wait);
+
+    return 0; 
+
+fail_malloc:
+    unregister_chrdev_region(devno, 1);
+    return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_exit
+* Description: globalfifo exit
+* Input:       Noen
+* Output:      None
+* Return:      None
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void __exit globalfifo_exit(void)
+{
+    cdev_del(&globalfifo_devp->cdev);
+    kfree(globalfifo_devp);
+    unregister_chrdev_region(MKDEV(globalfifo_major, 0), 1);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_setup_cdev
+* Description: globalfifo setup cdev struct 
+* Input:       index: cdev index node
+* Output:      dev: initialed cdev 
+* Return:      None
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index)
+{
+  int err, devno = MKDEV(globalfifo_major, index);
+
+  cdev_init(&dev->cdev, &globalfifo_fops);
+  dev->cdev.owner = THIS_MODULE;
+
+  err = cdev_add(&dev->cdev, devno, 1);
+  if (err) 
+    log_debug("Error %d adding globalfifo%d", err, index);
+
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_get
+* Description: copy data out of the ring to user space and advance the head index,
+*              the data may wrap around the end of mem[] so it is copied in two segments
+* Input:       dev: globalfifo device
+*              size: read data size, must not exceed current_len
+* Output:      buf: read buffer
+* Return:      0: execute success
+*              -EFAULT: copy to user failure, the ring is left untouched
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Keep the free-running head position
+
+********************************************************************************************/
+static int globalfifo_ring_get(struct globalfifo_dev * dev, char __user * buf, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->head);
+
+  if (copy_to_user(buf, dev->mem + dev->head, first))
+    return -EFAULT;
+
+  if (copy_to_user(buf + first, dev->mem, size - first))
+    return -EFAULT;
+
+  dev->head = (dev->head + size) & GLOBALFIFO_MASK;
+  dev->hpos += size;
+  dev->current_len -= size;
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_put
+* Description: copy data from user space into the ring and advance the tail index,
+*              the free space may wrap around the end of mem[] so it is filled in two segments
+* Input:       dev: globalfifo device
+*              buf: write buffer
+*              size: write data size, must not exceed the free space
+* Output:      None
+* Return:      0: execute success
+*              -EFAULT: copy from user failure, the ring is left untouched
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_ring_put(struct globalfifo_dev * dev, const char __user * buf, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->tail);
+
+  if (copy_from_user(dev->mem + dev->tail, buf, first))
+    return -EFAULT;
+
+  if (copy_from_user(dev->mem, buf + first, size - first))
+    return -EFAULT;
+
+  dev->tail = (dev->tail + size) & GLOBALFIFO_MASK;
+  dev->current_len += size;
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_peek
+* Description: copy data out of the ring to kernel space without consuming it
+* Input:       dev: globalfifo device
+*              off: offset from head
+*              size: data size, off + size must not exceed current_len
+* Output:      dst: kernel buffer
+* Return:      None
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Peek at an offset from head
+
+********************************************************************************************/
+static void globalfifo_ring_peek(struct globalfifo_dev * dev, void * dst, unsigned int off, unsigned int size)
+{
+  unsigned int pos = (dev->head + off) & GLOBALFIFO_MASK;
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - pos);
+
+  memcpy(dst, dev->mem + pos, first);
+  memcpy(dst + first, dev->mem, size - first);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_mark
+* Description: set a flag in the length header of a queued record
+* Input:       dev: globalfifo device
+*              off: offset of the record from head
+*              flag: GLOBALFIFO_REC_TAKEN or GLOBALFIFO_REC_SKIPPED
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_ring_mark(struct globalfifo_dev * dev, unsigned int off, u32 flag)
+{
+  u32 hdr;
+  unsigned int pos = (dev->head + off) & GLOBALFIFO_MASK;
+  unsigned int first = min_t(unsigned int, GLOBALFIFO_HDR_SIZE, GLOBALFIFO_SIZE - pos);
+
+  globalfifo_ring_peek(dev, &hdr, off, GLOBALFIFO_HDR_SIZE);
+  hdr |= flag;
+
+  memcpy(dev->mem + pos, &hdr, first);
+  memcpy(dev->mem, (void *)&hdr + first, GLOBALFIFO_HDR_SIZE - first);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_copy_out
+* Description: copy data out of the ring to user space without consuming it
+* Input:       dev: globalfifo device
+*              off: offset from head
+*              size: data size, off + size must not exceed current_len
+* Output:      buf: read buffer
+* Return:      0: execute success
+*              -EFAULT: copy to user failure
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_ring_copy_out(struct globalfifo_dev * dev, char __user * buf, unsigned int off, unsigned int size)
+{
+  unsigned int pos = (dev->head + off) & GLOBALFIFO_MASK;
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - pos);
+
+  if (copy_to_user(buf, dev->mem + pos, first))
+    return -EFAULT;
+
+  if (copy_to_user(buf + first, dev->mem, size - first))
+    return -EFAULT;
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_put_kernel
+* Description: copy data from kernel space into the ring and advance the tail index
+* Input:       dev: globalfifo device
+*              src: kernel buffer
+*              size: data size, must not exceed the free space
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_ring_put_kernel(struct globalfifo_dev * dev, const void * src, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->tail);
+
+  memcpy(dev->mem + dev->tail, src, first);
+  memcpy(dev->mem, src + first, size - first);
+
+  dev->tail = (dev->tail + size) & GLOBALFIFO_MASK;
+  dev->current_len += size;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_record_get
+* Description: take whole records out of the queue to user space
+* Input:       gf: per file state
+*              size: user buffer size
+*              off: offset from head of the record globalfifo_filter_find() found
+* Output:      buf: read buffer
+* Return:      ssize_t: read data count
+*              -EMSGSIZE: the next record does not fit into buf, it stays queued
+*              -EFAULT: copy to user failure, the record stays queued
+* Others:      caller must hold dev->mutex and release the taken records with
+*              globalfifo_reclaim(). Without batch only the payload of one record is
+*              returned, with batch as many passing records as fit are returned back to
+*              back, each preceded by its u32 length, the rejected ones in between are
+*              skipped. A batch that faults after the first record returns what was copied.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Skip the records the read filter rejects
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Take the record at the cursor instead of the head record
+
+********************************************************************************************/
+static ssize_t globalfifo_record_get(struct globalfifo_file * gf, char __user * buf, size_t size, unsigned int off)
+{
+  u32 len;
+  size_t copied = 0;
+  struct globalfifo_dev * dev = gf->dev;
+
+  globalfifo_ring_peek(dev, &len, off, GLOBALFIFO_HDR_SIZE);
+  len &= GLOBALFIFO_REC_LEN_MASK;
+
+  if (!gf->batch) {
+    if (len > size)
+      return -EMSGSIZE;
+
+    if (globalfifo_ring_copy_out(dev, buf, off + GLOBALFIFO_HDR_SIZE, len))
+      return -EFAULT;
+
+    globalfifo_ring_mark(dev, off, GLOBALFIFO_REC_TAKEN);
+    gf->cursor = dev->hpos + off + GLOBALFIFO_HDR_SIZE + len;
+    gf->passed = false;
+    log_debug("read record of %u bytes(s), current_len:%d\n", len, dev->current_len);
+    return len;
+  }
+
+  if (GLOBALFIFO_HDR_SIZE + len > size)
+    return -EMSGSIZE;
+
+  do {
+    if (copy_to_user(buf + copied, &len, GLOBALFIFO_HDR_SIZE) ||
+        globalfifo_ring_copy_out(dev, buf + copied + GLOBALFIFO_HDR_SIZE, off + GLOBALFIFO_HDR_SIZE, len))
+      return copied ? copied : -EFAULT;
+
+    globalfifo_ring_mark(dev, off, GLOBALFIFO_REC_TAKEN);
+    gf->cursor = dev->hpos + off + GLOBALFIFO_HDR_SIZE + len;
+    gf->passed = false;
+    copied += GLOBALFIFO_HDR_SIZE + len;
+    if (!globalfifo_filter_find(gf, true, &off))
+      break;
+
+    globalfifo_ring_peek(dev, &len, off, GLOBALFIFO_HDR_SIZE);
+    len &= GLOBALFIFO_REC_LEN_MASK;
+  } while (copied + GLOBALFIFO_HDR_SIZE + len <= size);
+
+  log_debug("read %zu bytes(s) of records, current_len:%d\n", copied, dev->current_len);
+  return copied;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_record_put
+* Description: enqueue one write as a length-prefixed record
+* Input:       dev: globalfifo device
+*              buf: write buffer
+*              size: record size, 1..GLOBALFIFO_MAX_RECORD
+* Output:      None
+* Return:      ssize_t: written data count
+*              -EFAULT: copy from user failure, nothing is queued
+*              -ENODATA: the fifo filter rejected the record, nothing is queued
+* Others:      caller must hold dev->mutex and have waited for globalfifo_write_room(size)
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Apply the fifo filter
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Count the rejected record here
+
+********************************************************************************************/
+static ssize_t globalfifo_record_put(struct globalfifo_dev * dev, const char __user * buf, size_t size)
+{
+  u32 len = size;
+  unsigned int tail = dev->tail;
+  unsigned int current_len = dev->current_len;
+
+  globalfifo_ring_put_kernel(dev, &len, GLOBALFIFO_HDR_SIZE);
+
+  if (globalfifo_ring_put(dev, buf, len)) {
+    dev->tail = tail;
+    dev->current_len = current_len;
+    return -EFAULT;
+  }
+
+  /* match in place, the payload is already in the ring and is just taken back */
+  if (!globalfifo_filter_match(dev, &dev->match, (tail + GLOBALFIFO_HDR_SIZE) & GLOBALFIFO_MASK, len, &dev->match.seen)) {
+    dev->match.dropped++;
+    dev->tail = tail;
+    dev->current_len = current_len;
+    return -ENODATA;
+  }
+
+  return len;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write_room
+* Description: free space a writer has to wait for
+* Input:       size: write data size
+* Output:      None
+* Return:      unsigned int: required free bytes
+* Others:      a stream write proceeds as soon as one byte is free, a record needs
+*              room for its header and the whole payload
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static unsigned int globalfifo_write_room(size_t size)
+{
+  if (!globalfifo_record)
+    return 1;
+
+  return GLOBALFIFO_HDR_SIZE + min_t(size_t, size, GLOBALFIFO_MAX_RECORD);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_filter_match
+* Description: run a filter over a record in the ring
+* Input:       dev: globalfifo device
+*              m: installed filter
+*              pos: ring index of the record payload
+*              len: payload length
+*              seen: sampling counter, m->seen or a copy of it
+* Output:      seen: advanced for a matching record
+* Return:      true: the record passes
+*              false: the record is rejected
+* Others:      caller must hold dev->mutex and counts the rejected record itself. The
+*              payload is compared where it sits in mem[], so a rejected record is never
+*              copied anywhere.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Leave counting the rejected record to the caller
+
+********************************************************************************************/
+static bool globalfifo_filter_match(struct globalfifo_dev * dev, struct globalfifo_match * m, unsigned int pos, u32 len, u32 * seen)
+{
+  struct globalfifo_filter * f = &m->filter;
+  bool hit = false;
+  u32 off, i;
+
+  if (!m->active)
+    return true;
+
+  for (off = f->offset; off + f->len <= len; off++) {
+    for (i = 0; i < f->len; i++) {
+      if ((dev->mem[(pos + off + i) & GLOBALFIFO_MASK] ^ f->value[i]) & f->mask[i])
+        break;
+    }
+
+    if (i == f->len) {
+      hit = true;
+      break;
+    }
+
+    if (!(f->flags & GLOBALFIFO_FILTER_SEARCH))
+      break;
+  }
+
+  if (f->flags & GLOBALFIFO_FILTER_INVERT)
+    hit = !hit;
+
+  if (hit && f->sample > 1)
+    hit = (*seen)++ % f->sample == 0;
+
+  return hit;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_filter_find
+* Description: find the next queued record the read filter of a file passes
+* Input:       gf: per file state of the reader
+*              commit: advance the cursor of gf past the rejected records
+* Output:      found: offset of the record from head
+* Return:      true: a record passed
+*              false: no queued record passed
+* Others:      caller must hold dev->mutex. Records taken by other readers are stepped
+*              over, the rejected ones are only marked GLOBALFIFO_REC_SKIPPED and stay
+*              queued for the other readers. Without commit nothing is changed, so
+*              poll() can ask. In stream mode nothing is filtered.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static bool globalfifo_filter_find(struct globalfifo_file * gf, bool commit, unsigned int * found)
+{
+  u32 len;
+  unsigned int off;
+  struct globalfifo_dev * dev = gf->dev;
+  u32 seen = gf->match.seen;
+
+  if (!globalfifo_record) {
+    *found = 0;
+    return dev->current_len != 0;
+  }
+
+  /* head may have moved past the cursor by a reclaim or a clear */
+  off = (int)(gf->cursor - dev->hpos) > 0 ? gf->cursor - dev->hpos : 0;
+
+  while (off < dev->current_len) {
+    globalfifo_ring_peek(dev, &len, off, GLOBALFIFO_HDR_SIZE);
+
+    if (!(len & GLOBALFIFO_REC_TAKEN)) {
+      if ((gf->passed && gf->pass_pos == dev->hpos + off) ||
+          globalfifo_filter_match(dev, &gf->match, (dev->head + off + GLOBALFIFO_HDR_SIZE) & GLOBALFIFO_MASK,
+                                  len & GLOBALFIFO_REC_LEN_MASK, &seen)) {
+        if (commit) {
+          gf->match.seen = seen;
+          gf->cursor = dev->hpos + off;
+          gf->pass_pos = gf->cursor;
+          gf->passed = true;
+        }
+        *found = off;
+        return true;
+      }
+
+      if (commit) {
+        globalfifo_ring_mark(dev, off, GLOBALFIFO_REC_SKIPPED);
+        gf->match.dropped++;
+      }
+    }
+
+    off += GLOBALFIFO_HDR_SIZE + (len & GLOBALFIFO_REC_LEN_MASK);
+  }
+
+  if (commit) {
+    gf->match.seen = seen;
+    gf->cursor = dev->hpos + off;
+  }
+
+  return false;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_reclaim
+* Description: free the records at the head that no reader needs any more
+* Input:       dev: globalfifo device
+*              commit: really move head, otherwise only count
+* Output:      None
+* Return:      unsigned int: bytes freed, or that a write would free without commit
+* Others:      caller must hold dev->mutex. Taken records always go. Records some reader
+*              skipped are kept for the readers that did not look at them yet, and go only
+*              while a writer waits for room, so a slow reader never blocks writers.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static unsigned int globalfifo_reclaim(struct globalfifo_dev * dev, bool commit)
+{
+  u32 len;
+  unsigned int off = 0;
+  bool skipped = !commit || waitqueue_active(&dev->w_wait);
+
+  if (!globalfifo_record)
+    return 0;
+
+  while (off < dev->current_len) {
+    globalfifo_ring_peek(dev, &len, off, GLOBALFIFO_HDR_SIZE);
+
+    if (!(len & GLOBALFIFO_REC_TAKEN) && !(skipped && (len & GLOBALFIFO_REC_SKIPPED)))
+      break;
+
+    off += GLOBALFIFO_HDR_SIZE + (len & GLOBALFIFO_REC_LEN_MASK);
+  }
+
+  if (commit && off != 0) {
+    dev->head = (dev->head + off) & GLOBALFIFO_MASK;
+    dev->hpos += off;
+    dev->current_len -= off;
+    wake_up_interruptible(&dev->w_wait);
+  }
+
+  return off;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_set_filter
+* Description: install or remove a filter
+* Input:       m: filter slot of a file or of the fifo
+*              arg: user pointer to struct globalfifo_filter, NULL removes the filter
+* Output:      None
+* Return:      0: execute success
+*              -EFAULT: arg cannot be read
+*              -EINVAL: the filter is malformed
+* Others:      caller must hold dev->mutex. The dropped counter keeps running across
+*              filters, the sampling restarts.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_set_filter(struct globalfifo_match * m, const void __user * arg)
+{
+  struct globalfifo_filter f;
+
+  if (!arg) {
+    m->active = false;
+    return 0;
+  }
+
+  if (copy_from_user(&f, arg, sizeof(f)))
+    return -EFAULT;
+
+  if (f.len > GLOBALFIFO_FILTER_LEN || f.offset > GLOBALFIFO_MAX_RECORD)
+    return -EINVAL;
+
+  if (f.flags & ~(GLOBALFIFO_FILTER_SEARCH | GLOBALFIFO_FILTER_INVERT))
+    return -EINVAL;
+
+  m->filter = f;
+  m->seen = 0;
+  m->active = true;
+
+  return 0;
+}
+
+
+/*
+  ** module declaration
+*/
+module_init(globalfifo_init);
+module_exit(globalfifo_exit);
+
+MODULE_AUTHOR("JexJiang");
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("A simple Hello World Module");
+MODULE_ALIAS("a simplest module");
+MODULE_VERSION("v1.0");
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
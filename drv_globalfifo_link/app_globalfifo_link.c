@@ -0,0 +1,100 @@
+/*
+  ** @file           : app_globalfifo_link.c
+  ** @brief          : global fifo in-kernel link application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   FIFO_LINK_CMD               (0x7)
+#define   FIFO_UNLINK_CMD             (0x8)
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list, "<src> <dst>" links /dev/globalfifo<src> to /dev/globalfifo<dst>,
+*                    "-u <src> <dst>" removes the link
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      the link stays after this program exits
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Pass the destination as a descriptor opened for writing
+
+********************************************************************************************/
+int main(int argc, char * argv[])
+{
+    int fd, dst_fd, unlink = 0;
+    char path[32], dst_path[32];
+
+    if (argc > 1 && '-' == argv[1][0] && 'u' == argv[1][1]) {
+        unlink = 1;
+        argc--;
+        argv++;
+    }
+
+    if (argc < 3) {
+        log_debug("usage: app_globalfifo_link [-u] <src minor> <dst minor>\n");
+        return -1;
+    }
+
+    snprintf(path, sizeof(path), "/dev/globalfifo%d", atoi(argv[1]));
+    fd = open(path, O_RDWR);
+    if (-1 == fd) {
+        log_debug("%s open failure\r\n", path);
+        return -1;
+    }
+
+    /* the destination is passed as a descriptor, so it has to be writable by us */
+    snprintf(dst_path, sizeof(dst_path), "/dev/globalfifo%d", atoi(argv[2]));
+    dst_fd = open(dst_path, O_WRONLY);
+    if (-1 == dst_fd) {
+        log_debug("%s open failure\r\n", dst_path);
+        return -1;
+    }
+
+    if (ioctl(fd, unlink ? FIFO_UNLINK_CMD : FIFO_LINK_CMD, dst_fd) < 0) {
+        perror("ioctl()");
+        return -1;
+    }
+
+    log_debug("%s %s %s\n", path, unlink ? "unlinked from" : "linked to", dst_path);
+    close(dst_fd);
+    close(fd);
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
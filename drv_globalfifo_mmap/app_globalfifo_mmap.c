@@ -0,0 +1,206 @@
+/*
+  ** @file           : app_globalfifo_mmap.c
+  ** @brief          : global fifo shared ring application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   FIFO_KICK_CMD               (0x2)
+#define   BUFFER_SIZE                 (20)
+
+
+/*
+  ** struct
+*/
+
+/* must match struct globalfifo_ring_ctrl in drv_globalfifo_mmap.c */
+struct globalfifo_ring_ctrl {
+  uint32_t head;
+  uint32_t tail;
+  uint32_t size;
+  uint32_t rd_wait;
+  uint32_t wr_wait;
+};
+
+
+/********************************************************************************************
+* Function:    ring_produce
+* Description: copy a message into the shared ring without entering the kernel
+* Input:       fd: globalfifo file descriptor
+*              ctrl: mapped control page
+*              data: mapped ring data
+*              buf: message
+*              len: message length
+* Output:      None
+* Return:      None
+* Others:      sleeps in poll() only while the ring is full
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void ring_produce(int fd, struct globalfifo_ring_ctrl * ctrl, unsigned char * data,
+                         const char * buf, uint32_t len)
+{
+  uint32_t i, head, tail = ctrl->tail;
+  struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+
+  for (i = 0; i < len; i++) {
+    head = __atomic_load_n(&ctrl->head, __ATOMIC_ACQUIRE);
+    while (tail - head == ctrl->size) {
+      /* publish what is already in the ring so a sleeping reader can drain it */
+      __atomic_store_n(&ctrl->tail, tail, __ATOMIC_RELEASE);
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      if (__atomic_load_n(&ctrl->rd_wait, __ATOMIC_RELAXED))
+        ioctl(fd, FIFO_KICK_CMD, 0);
+
+      poll(&pfd, 1, -1);
+      head = __atomic_load_n(&ctrl->head, __ATOMIC_ACQUIRE);
+    }
+
+    data[tail & (ctrl->size - 1)] = buf[i];
+    tail++;
+  }
+
+  __atomic_store_n(&ctrl->tail, tail, __ATOMIC_RELEASE);
+
+  /* pairs with the barrier the driver issues after setting rd_wait */
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&ctrl->rd_wait, __ATOMIC_RELAXED))
+    ioctl(fd, FIFO_KICK_CMD, 0);
+}
+
+
+/********************************************************************************************
+* Function:    ring_consume
+* Description: copy available bytes out of the shared ring without entering the kernel
+* Input:       fd: globalfifo file descriptor
+*              ctrl: mapped control page
+*              data: mapped ring data
+*              len: buffer length
+* Output:      buf: received bytes
+* Return:      uint32_t: received byte count
+* Others:      sleeps in poll() only while the ring is empty
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static uint32_t ring_consume(int fd, struct globalfifo_ring_ctrl * ctrl, unsigned char * data,
+                             char * buf, uint32_t len)
+{
+  uint32_t i, head = ctrl->head, tail;
+  struct pollfd pfd = { .fd = fd, .events = POLLIN };
+
+  tail = __atomic_load_n(&ctrl->tail, __ATOMIC_ACQUIRE);
+  while (tail == head) {
+    poll(&pfd, 1, -1);
+    tail = __atomic_load_n(&ctrl->tail, __ATOMIC_ACQUIRE);
+  }
+
+  for (i = 0; i < len && head != tail; i++, head++)
+    buf[i] = data[head & (ctrl->size - 1)];
+
+  __atomic_store_n(&ctrl->head, head, __ATOMIC_RELEASE);
+
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&ctrl->wr_wait, __ATOMIC_RELAXED))
+    ioctl(fd, FIFO_KICK_CMD, 0);
+
+  return i;
+}
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list, "w" runs the producer, anything else the consumer
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+int main(int argc, char * argv[])
+{
+    int fd, num = 0;
+    long page = sysconf(_SC_PAGESIZE);
+    char buf[BUFFER_SIZE];
+    void * area;
+    struct globalfifo_ring_ctrl * ctrl;
+
+    fd = open("/dev/globalfifo", O_RDWR);
+    if (-1 == fd) {
+        log_debug("/dev/globalfifo open failure\r\n");
+        return -1;
+    }
+
+    ctrl = mmap(NULL, page, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == ctrl) {
+        perror("mmap()");
+        return -1;
+    }
+
+    area = mmap(NULL, page + ((ctrl->size + page - 1) & ~(page - 1)),
+                PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    munmap(ctrl, page);
+    if (MAP_FAILED == area) {
+        perror("mmap()");
+        return -1;
+    }
+    ctrl = area;
+
+    if (argc > 1 && 'w' == argv[1][0]) {
+        while (1) {
+            snprintf(buf, sizeof(buf), "msg %d\n", num++);
+            ring_produce(fd, ctrl, (unsigned char *)area + page, buf, strlen(buf));
+            sleep(1);
+        }
+    } else {
+        while (1) {
+            num = ring_consume(fd, ctrl, (unsigned char *)area + page, buf, sizeof(buf) - 1);
+            buf[num] = '\0';
+            log_debug("ring: %s", buf);
+        }
+    }
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
@@ -0,0 +1,796 @@
+/*
+  ** @file           : drv_globalfifo_mmap.c
+  ** @brief          : global fifo shared ring (mmap) driver source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/cdev.h>
+#include <linux/kern_levels.h>
+#include <linux/printk.h>
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/sched/signal.h>
+#include <linux/memory.h>
+#include <linux/poll.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
+
+
+/*
+  ** define
+*/
+#define     GLOBALFIFO_SIZE         (0x1000)
+#define     GLOBALFIFO_MASK         (GLOBALFIFO_SIZE - 1)
+#define     MEM_CLEAR_CMD           (0x1)
+#define     FIFO_KICK_CMD           (0x2)
+#define     GLOBALFIFO_MAJOR        (230)
+
+/*
+  ** mmap layout: one control page followed by the data pages, offset 0 maps both
+*/
+#define     GLOBALFIFO_CTRL_SIZE    (PAGE_SIZE)
+#define     GLOBALFIFO_DATA_SIZE    (PAGE_ALIGN(GLOBALFIFO_SIZE))
+#define     GLOBALFIFO_AREA_SIZE    (GLOBALFIFO_CTRL_SIZE + GLOBALFIFO_DATA_SIZE)
+
+#define     log_debug(fmt, ...)     printk(KERN_DEBUG   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_info(fmt, ...)      printk(KERN_INFO    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_notice(fmt, ...)    printk(KERN_NOTICE  pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_warning(fmt, ...)   printk(KERN_WARNING pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_err(fmt, ...)       printk(KERN_ERR     pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_crit(fmt, ...)      printk(KERN_CRIT    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_alert(fmt, ...)     printk(KERN_ALERT   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_emerg(fmt, ...)     printk(KERN_EMERG   pr_fmt(fmt), ##__VA_ARGS__)
+
+
+/*
+  ** struct
+*/
+
+/*
+  ** control page shared with user space, must match app_globalfifo_mmap.c
+  ** head/tail are free-running byte counters, the data offset is counter & (size - 1).
+  ** The producer publishes tail with release semantics, the consumer publishes head
+  ** with release semantics. rd_wait/wr_wait are set by the kernel when a reader or
+  ** writer is about to sleep, a user-space peer that sees them set after publishing
+  ** its index issues FIFO_KICK_CMD so the sleeper is woken.
+*/
+struct globalfifo_ring_ctrl {
+  __u32 head;
+  __u32 tail;
+  __u32 size;
+  __u32 rd_wait;
+  __u32 wr_wait;
+};
+
+struct globalfifo_dev {
+  struct cdev cdev;
+  void * area;
+  struct globalfifo_ring_ctrl * ctrl;
+  unsigned char * mem;
+  struct mutex mutex;
+  wait_queue_head_t r_wait;
+  wait_queue_head_t w_wait;
+  struct fasync_struct * async_queue;
+};
+
+
+/*
+  ** static function declaration
+*/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos);
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos);
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig);
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg);
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait);
+static int globalfifo_mmap(struct file * filp, struct vm_area_struct * vma);
+static int globalfifo_open(struct inode * inode, struct file * filp);
+static int globalfifo_release(struct inode * inode, struct file *filp);
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index);
+static int globalfifo_fasync(int fd, struct file * filp, int mode);
+static int globalfifo_ring_len(struct globalfifo_dev * dev, unsigned int head, unsigned int tail);
+static bool globalfifo_ring_readable(struct globalfifo_dev * dev);
+static bool globalfifo_ring_writable(struct globalfifo_dev * dev);
+
+
+/*
+  ** global variable
+*/
+static const struct file_operations globalfifo_fops = {
+  .owner = THIS_MODULE,
+  .llseek = globalfifo_llseek,
+  .read = globalfifo_read,
+  .write = globalfifo_write,
+  .unlocked_ioctl = globalfifo_ioctl,
+  .poll = globalfifo_poll,
+  .mmap = globalfifo_mmap,
+  .fasync = globalfifo_fasync,
+  .open = globalfifo_open,
+  .release = globalfifo_release,
+};
+
+
+/*
+  ** static global variable
+*/
+static int globalfifo_major = GLOBALFIFO_MAJOR;
+module_param(globalfifo_major, int, S_IRUGO);
+
+struct globalfifo_dev * globalfifo_devp;
+
+
+/*
+  ** static function list
+*/
+
+/********************************************************************************************
+* Function:    globalfifo_read
+* Description: globalfifo read data
+* Input:       filp: struct file
+*              size: read data size
+*              ppos: pos offset
+* Output:      buf: read buffer
+* Return:      ssize_t: read data count
+* Others:      consumes from the shared ring, so a user-space producer working on the
+*              mmap()ed ring and a read() consumer can be combined
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Consume from the shared control page indices
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Set the task state before arming rd_wait so a kick cannot be lost
+
+********************************************************************************************/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos)
+{
+  int ret = 0;
+  int len;
+  unsigned int head, tail, off, first;
+  struct globalfifo_dev *dev = filp->private_data;
+
+  DECLARE_WAITQUEUE(wait, current);
+
+  mutex_lock(&dev->mutex);
+  add_wait_queue(&dev->r_wait, &wait);
+
+  while (1) {
+    /*
+      ** FIFO_KICK_CMD wakes without dev->mutex, so the state is set before rd_wait is
+      ** armed and checked like in wait_event(), a kick in between then finds us
+    */
+    set_current_state(TASK_INTERRUPTIBLE);
+    if (globalfifo_ring_readable(dev))
+      break;
+
+    if (filp->f_flags & O_NONBLOCK) {
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    mutex_unlock(&dev->mutex);
+
+    schedule();
+    if(signal_pending(current)) {
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+  }
+  __set_current_state(TASK_RUNNING);
+
+  head = READ_ONCE(dev->ctrl->head);
+  tail = smp_load_acquire(&dev->ctrl->tail);
+  len = globalfifo_ring_len(dev, head, tail);
+  if (len < 0) {
+    ret = len;
+    goto out;
+  }
+
+  if (size > len)
+    size = len;
+
+  off = head & GLOBALFIFO_MASK;
+  first = min_t(unsigned int, size, GLOBALFIFO_SIZE - off);
+
+  if (copy_to_user(buf, dev->mem + off, first) ||
+      copy_to_user(buf + first, dev->mem, size - first)) {
+    ret = -EFAULT;
+    goto out;
+  } else {
+    smp_store_release(&dev->ctrl->head, head + size);
+    log_debug("read %d bytes(s), current_len:%d\n", size, len - size);
+
+    WRITE_ONCE(dev->ctrl->wr_wait, 0);
+    wake_up_interruptible(&dev->w_wait);
+    ret = size;
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+
+out2:
+  remove_wait_queue(&dev->r_wait, &wait);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write
+* Description: globalfifo write data
+* Input:       filp: struct file
+*              buf: write buffer
+*              size: write data size
+*              ppos: pos offset
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      produces into the shared ring, see globalfifo_read()
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Produce into the shared control page indices
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Set the task state before arming wr_wait so a kick cannot be lost
+
+********************************************************************************************/
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos)
+{
+  int ret = 0;
+  int len;
+  unsigned int head, tail, off, first;
+  struct globalfifo_dev * dev = filp->private_data;
+
+  DECLARE_WAITQUEUE(wait, current);
+
+  mutex_lock(&dev->mutex);
+  add_wait_queue(&dev->w_wait, &wait);
+
+  while (1) {
+    set_current_state(TASK_INTERRUPTIBLE);
+    if (globalfifo_ring_writable(dev))
+      break;
+
+    if (filp->f_flags & O_NONBLOCK) {
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    mutex_unlock(&dev->mutex);
+    schedule();
+
+    if (signal_pending(current)) {
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+  }
+  __set_current_state(TASK_RUNNING);
+
+  head = smp_load_acquire(&dev->ctrl->head);
+  tail = READ_ONCE(dev->ctrl->tail);
+  len = globalfifo_ring_len(dev, head, tail);
+  if (len < 0) {
+    ret = len;
+    goto out;
+  }
+
+  if (size >= GLOBALFIFO_SIZE - len)
+    size = GLOBALFIFO_SIZE - len;
+
+  off = tail & GLOBALFIFO_MASK;
+  first = min_t(unsigned int, size, GLOBALFIFO_SIZE - off);
+
+  if (copy_from_user(dev->mem + off, buf, first) ||
+      copy_from_user(dev->mem, buf + first, size - first)) {
+    ret = -EFAULT;
+    goto out;
+  } else {
+    smp_store_release(&dev->ctrl->tail, tail + size);
+    log_debug("written %u bytes(s), current_len:%d\n", size, len + size);
+
+    WRITE_ONCE(dev->ctrl->rd_wait, 0);
+    wake_up_interruptible(&dev->r_wait);
+
+    if (dev->async_queue) {
+      kill_fasync(&dev->async_queue, SIGIO, POLL_IN);
+      log_debug("%s kill SIGIO\n", __func__);
+    }
+
+    ret = size;
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+out2:
+  remove_wait_queue(&dev->w_wait, &wait);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_llseek
+* Description: globalfifo llseek pos
+* Input:       filp: struct file
+*              offset: pos offse
+*              orig: pos flag
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig)
+{
+  loff_t ret = 0;
+  switch (orig) {
+  case 0:
+    if (offset < 0) {
+      ret = -EINVAL;
+      break;
+    }
+
+    if((unsigned int)offset > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }
+
+    filp->f_pos = (unsigned int)offset;
+    ret = filp->f_pos;
+    break;
+  case 1:
+    if ((filp->f_pos + offset) > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }
+
+    if ((filp->f_pos + offset) < 0) {
+      ret = -EINVAL;
+      break;
+    }
+    filp->f_pos += offset;
+    ret = filp->f_pos;
+    break;
+
+  default:
+    ret = -EINVAL;
+    break;
+
+  }
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ioctl
+* Description: globalfifo ioctl
+* Input:       filp: struct file
+*              cmd: command
+*              arg: argue
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      FIFO_KICK_CMD is issued by a user-space peer after it moved head or tail
+*              in the mmap()ed control page and found rd_wait/wr_wait set
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_KICK_CMD
+
+********************************************************************************************/
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg)
+{
+  struct globalfifo_dev * dev = filp->private_data;
+
+  switch (cmd)
+  {
+  case MEM_CLEAR_CMD:
+    memset(dev->mem, 0, GLOBALFIFO_SIZE);
+    log_debug("globalfifo is set to zero\n");
+    break;
+
+  case FIFO_KICK_CMD:
+    WRITE_ONCE(dev->ctrl->rd_wait, 0);
+    WRITE_ONCE(dev->ctrl->wr_wait, 0);
+    wake_up_interruptible(&dev->r_wait);
+    wake_up_interruptible(&dev->w_wait);
+
+    if (dev->async_queue)
+      kill_fasync(&dev->async_queue, SIGIO, POLL_IN);
+    break;
+
+  default:
+    return -EINVAL;
+    break;
+  }
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_poll
+* Description: globalfifo poll
+* Input:       filp: struct file
+*              poll_table: poll table pointer
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      this is where mmap users sleep when the ring is empty or full
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Check the shared ring and request a kick before sleeping
+
+********************************************************************************************/
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait)
+{
+  unsigned int mask = 0;
+  struct globalfifo_dev * dev = filp->private_data;
+
+  poll_wait(filp, &dev->r_wait, wait);
+  poll_wait(filp, &dev->w_wait, wait);
+
+  if ((filp->f_mode & FMODE_READ) && globalfifo_ring_readable(dev)) {
+    mask |= POLLIN | POLLRDNORM;
+  }
+
+  if ((filp->f_mode & FMODE_WRITE) && globalfifo_ring_writable(dev)) {
+    mask |= POLLOUT | POLLWRNORM;
+  }
+
+  if (globalfifo_ring_len(dev, READ_ONCE(dev->ctrl->head), READ_ONCE(dev->ctrl->tail)) < 0) {
+    mask |= POLLERR;
+  }
+
+  return mask;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_mmap
+* Description: globalfifo mmap, maps the control page and the ring data pages
+* Input:       filp: struct file
+*              vma: user virtual memory area
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      the mapping must be MAP_SHARED, start at offset 0 and may not exceed
+*              GLOBALFIFO_AREA_SIZE, the data area starts at GLOBALFIFO_CTRL_SIZE
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Refuse mappings without VM_SHARED
+
+********************************************************************************************/
+static int globalfifo_mmap(struct file * filp, struct vm_area_struct * vma)
+{
+  struct globalfifo_dev * dev = filp->private_data;
+
+  /* with MAP_PRIVATE the head/tail stores of each side would land in copy-on-write pages */
+  if (!(vma->vm_flags & VM_SHARED))
+    return -EINVAL;
+
+  if (vma->vm_pgoff != 0)
+    return -EINVAL;
+
+  if (vma->vm_end - vma->vm_start > GLOBALFIFO_AREA_SIZE)
+    return -EINVAL;
+
+  return remap_vmalloc_range(vma, dev->area, 0);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_fasync
+* Description: globalfifo fasync
+* Input:       fd: file descriptor
+*              filp: struct file
+*              mode: file mode
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_fasync(int fd, struct file * filp, int mode)
+{
+  struct globalfifo_dev * dev = filp->private_data;
+
+  return fasync_helper(fd, filp, mode, &dev->async_queue);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_open
+* Description: globalfifo open
+* Input:       inode: inode
+* Output:      filp: strcut file
+* Return:      0: execute success
+*              other: execute failure
+* Others:
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_open(struct inode * inode, struct file * filp)
+{
+  filp->private_data = globalfifo_devp;
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_release
+* Description: globalfifo relesase
+* Input:       inode: inode
+*              filp: strcut file
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_release(struct inode * inode, struct file *filp)
+{
+  globalfifo_fasync(-1, filp, 0);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_init
+* Description: globalfifo initial
+* Input:       Noen
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Allocate the mmap()able control page and ring
+
+********************************************************************************************/
+static int __init globalfifo_init(void)
+{
+    int ret;
+
+    dev_t devno = MKDEV(globalfifo_major, 0);
+
+    if (globalfifo_major)
+      ret = register_chrdev_region(devno, 1, "globalfifo");
+    else {
+      ret = alloc_chrdev_region(&devno, 0, 1, "globalfifo");
+      globalfifo_major = MAJOR(devno);
+    }
+
+    if (ret < 0)
+      return ret;
+
+    globalfifo_devp = kzalloc(sizeof(struct globalfifo_dev), GFP_KERNEL);
+    if (!globalfifo_devp) {
+      ret = -ENOMEM;
+      goto fail_malloc;
+    }
+
+    /* vmalloc_user() returns zeroed memory that remap_vmalloc_range() accepts */
+    globalfifo_devp->area = vmalloc_user(GLOBALFIFO_AREA_SIZE);
+    if (!globalfifo_devp->area) {
+      ret = -ENOMEM;
+      goto fail_area;
+    }
+
+    globalfifo_devp->ctrl = globalfifo_devp->area;
+    globalfifo_devp->mem = globalfifo_devp->area + GLOBALFIFO_CTRL_SIZE;
+    globalfifo_devp->ctrl->size = GLOBALFIFO_SIZE;
+
+    mutex_init(&globalfifo_devp->mutex);
+    init_waitqueue_head(&globalfifo_devp->r_wait);
+    init_waitqueue_head(&globalfifo_devp->w_wait);
+    globalfifo_setup_cdev(globalfifo_devp, 0);
+
+    return 0;
+
+fail_area:
+    kfree(globalfifo_devp);
+fail_malloc:
+    unregister_chrdev_region(devno, 1);
+    return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_exit
+* Description: globalfifo exit
+* Input:       Noen
+* Output:      None
+* Return:      None
+* Others:
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void __exit globalfifo_exit(void)
+{
+    cdev_del(&globalfifo_devp->cdev);
+    vfree(globalfifo_devp->area);
+    kfree(globalfifo_devp);
+    unregister_chrdev_region(MKDEV(globalfifo_major, 0), 1);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_setup_cdev
+* Description: globalfifo setup cdev struct
+* Input:       index: cdev index node
+* Output:      dev: initialed cdev
+* Return:      None
+* Others:
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index)
+{
+  int err, devno = MKDEV(globalfifo_major, index);
+
+  cdev_init(&dev->cdev, &globalfifo_fops);
+  dev->cdev.owner = THIS_MODULE;
+
+  err = cdev_add(&dev->cdev, devno, 1);
+  if (err)
+    log_debug("Error %d adding globalfifo%d", err, index);
+
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_len
+* Description: globalfifo shared ring fill level
+* Input:       dev: globalfifo device
+*              head: consumer counter
+*              tail: producer counter
+* Output:      None
+* Return:      int: bytes buffered
+*              -EIO: the indices in the control page are inconsistent
+* Others:      head and tail live in memory that user space can scribble on, so the
+*              distance is validated before it is used to index mem[]
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_ring_len(struct globalfifo_dev * dev, unsigned int head, unsigned int tail)
+{
+  if (tail - head > GLOBALFIFO_SIZE)
+    return -EIO;
+
+  return tail - head;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_readable
+* Description: check whether the shared ring holds data, otherwise ask the producer for a kick
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      true: data (or a corrupted ring) is available
+*              false: the ring is empty
+* Others:      rd_wait is set before the final check, the full barrier pairs with the one a
+*              user-space producer issues between publishing tail and testing rd_wait
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static bool globalfifo_ring_readable(struct globalfifo_dev * dev)
+{
+  if (READ_ONCE(dev->ctrl->tail) != READ_ONCE(dev->ctrl->head))
+    return true;
+
+  WRITE_ONCE(dev->ctrl->rd_wait, 1);
+  smp_mb();
+
+  return READ_ONCE(dev->ctrl->tail) != READ_ONCE(dev->ctrl->head);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_writable
+* Description: check whether the shared ring has free space, otherwise ask the consumer for a kick
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      true: free space (or a corrupted ring) is available
+*              false: the ring is full
+* Others:      mirror of globalfifo_ring_readable()
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static bool globalfifo_ring_writable(struct globalfifo_dev * dev)
+{
+  if (READ_ONCE(dev->ctrl->tail) - READ_ONCE(dev->ctrl->head) != GLOBALFIFO_SIZE)
+    return true;
+
+  WRITE_ONCE(dev->ctrl->wr_wait, 1);
+  smp_mb();
+
+  return READ_ONCE(dev->ctrl->tail) - READ_ONCE(dev->ctrl->head) != GLOBALFIFO_SIZE;
+}
+
+
+/*
+  ** module declaration
+*/
+module_init(globalfifo_init);
+module_exit(globalfifo_exit);
+
+MODULE_AUTHOR("JexJiang");
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("A simple Hello World Module");
+MODULE_ALIAS("a simplest module");
+MODULE_VERSION("v1.0");
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
@@ -0,0 +1,95 @@
+/*
+  ** @file           : app_globalfifo_overwrite.c
+  ** @brief          : global fifo overwrite oldest application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   FIFO_GET_DROPPED_CMD        (0x7)
+#define   BUFFER_SIZE                 (64)
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list, "w" runs the producer, anything else the consumer
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      the producer never sleeps, the slow consumer reports how much it missed
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+int main(int argc, char * argv[])
+{
+    int fd, num = 0;
+    ssize_t len;
+    uint64_t dropped;
+    char buf[BUFFER_SIZE];
+
+    fd = open("/dev/globalfifo", O_RDWR);
+    if (-1 == fd) {
+        log_debug("/dev/globalfifo open failure\r\n");
+        return -1;
+    }
+
+    if (argc > 1 && 'w' == argv[1][0]) {
+        while (1) {
+            snprintf(buf, sizeof(buf), "msg %d\n", num++);
+            if (write(fd, buf, strlen(buf)) < 0) {
+                perror("write()");
+                return -1;
+            }
+        }
+    }
+
+    while (1) {
+        len = read(fd, buf, sizeof(buf) - 1);
+        if (len < 0) {
+            perror("read()");
+            return -1;
+        }
+        buf[len] = '\0';
+
+        if (0 == ioctl(fd, FIFO_GET_DROPPED_CMD, &dropped) && dropped)
+            log_debug("%llu bytes overwritten before this read\n", (unsigned long long)dropped);
+
+        log_debug("read: %s", buf);
+        sleep(1);
+    }
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
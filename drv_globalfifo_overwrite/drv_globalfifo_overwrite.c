@@ -0,0 +1,1394 @@
+/*
+  ** @file           : drv_globalfifo_overwrite.c
+  ** @brief          : global fifo overwrite oldest driver source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/cdev.h>
+#include <linux/kern_levels.h>
+#include <linux/printk.h>
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/sched/signal.h>
+#include <linux/memory.h>
+#include <linux/poll.h>
+#include <linux/timekeeping.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/eventfd.h>
+#include <linux/version.h>
+
+
+/*
+  ** define
+*/
+#define     GLOBALFIFO_SIZE         (0x1000)
+#define     GLOBALFIFO_MASK         (GLOBALFIFO_SIZE - 1)
+#define     MEM_CLEAR_CMD           (0x1)
+#define     FIFO_SET_RCVLOWAT_CMD   (0x2)
+#define     FIFO_SET_SNDLOWAT_CMD   (0x3)
+#define     FIFO_SET_RD_EVENTFD_CMD (0x4)
+#define     FIFO_SET_WR_EVENTFD_CMD (0x5)
+#define     FIFO_SET_ATOMIC_CMD     (0x6)
+#define     FIFO_GET_DROPPED_CMD    (0x7)
+#define     GLOBALFIFO_MAJOR        (230)
+
+#define     log_debug(fmt, ...)     printk(KERN_DEBUG   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_info(fmt, ...)      printk(KERN_INFO    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_notice(fmt, ...)    printk(KERN_NOTICE  pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_warning(fmt, ...)   printk(KERN_WARNING pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_err(fmt, ...)       printk(KERN_ERR     pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_crit(fmt, ...)      printk(KERN_CRIT    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_alert(fmt, ...)     printk(KERN_ALERT   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_emerg(fmt, ...)     printk(KERN_EMERG   pr_fmt(fmt), ##__VA_ARGS__)
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 8, 0)
+#define     globalfifo_eventfd_signal(ctx)  eventfd_signal(ctx)
+#else
+#define     globalfifo_eventfd_signal(ctx)  eventfd_signal(ctx, 1)
+#endif
+
+
+/*
+  ** struct
+*/
+
+/*
+  ** counters exported through /sys/kernel/debug/globalfifo/stats, all protected by
+  ** dev->mutex. A sleep is counted when it starts, its time once the sleeper holds
+  ** the mutex again, so a sleep cut short by a signal adds no time.
+*/
+struct globalfifo_stats {
+  u64 rd_bytes;
+  u64 rd_sleeps;
+  u64 rd_sleep_ns;
+  u64 rd_eagain;
+  u64 wr_bytes;
+  u64 wr_sleeps;
+  u64 wr_sleep_ns;
+  u64 wr_eagain;
+  unsigned int max_len;
+};
+
+struct globalfifo_dev {
+  struct cdev cdev;
+  unsigned int current_len;
+  unsigned int head;
+  unsigned int tail;
+  unsigned char mem[GLOBALFIFO_SIZE];
+  struct mutex mutex;
+  wait_queue_head_t r_wait;
+  wait_queue_head_t w_wait;
+  struct list_head files;
+  unsigned int rcvlowat_min;
+  unsigned int sndlowat_min;
+  struct globalfifo_stats stats;
+  struct dentry * debugfs;
+  u64 dropped;
+};
+
+/*
+  ** per open file state, rcvlowat/sndlowat are the low watermarks of this file:
+  ** a read blocks and POLLIN stays clear until rcvlowat bytes are buffered, a write
+  ** blocks and POLLOUT stays clear until sndlowat bytes are free, SIGIO is only sent
+  ** to this file once rcvlowat bytes are buffered. rd_eventfd/wr_eventfd are signalled
+  ** under the same watermarks when data arrives or space is freed.
+  ** rd_sig_pending/wr_sig_pending mark a POLL_IN/POLL_OUT signal that was sent and not
+  ** yet acted upon, see globalfifo_notify_readers().
+  ** atomic works like PIPE_BUF: a write of up to atomic bytes is never split, 0 turns it off.
+  ** POLLOUT, POLL_OUT and the write eventfd then also wait for atomic free bytes.
+  ** dropped_seen is dev->dropped at the last FIFO_GET_DROPPED_CMD of this file.
+*/
+struct globalfifo_file {
+  struct globalfifo_dev * dev;
+  struct list_head list;
+  fmode_t mode;
+  unsigned int rcvlowat;
+  unsigned int sndlowat;
+  unsigned int atomic;
+  struct fasync_struct * async_queue;
+  struct eventfd_ctx * rd_eventfd;
+  struct eventfd_ctx * wr_eventfd;
+  bool rd_sig_pending;
+  bool wr_sig_pending;
+  u64 dropped_seen;
+};
+
+/*
+  ** wait queue entry of a blocked reader or writer, see globalfifo_read_wake(),
+  ** size is the length of a blocked write
+*/
+struct globalfifo_waiter {
+  wait_queue_entry_t wq;
+  struct globalfifo_file * gf;
+  size_t size;
+};
+
+
+/*
+  ** static function declaration
+*/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos);
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos);
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig);
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg);
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait);
+static int globalfifo_open(struct inode * inode, struct file * filp);
+static int globalfifo_release(struct inode * inode, struct file *filp);
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index);
+static void globalfifo_update_lowat(struct globalfifo_dev * dev);
+static unsigned int globalfifo_write_need(struct globalfifo_file * gf, size_t size);
+static size_t globalfifo_make_room(struct globalfifo_dev * dev, size_t size);
+static int globalfifo_stats_show(struct seq_file * s, void * unused);
+static int globalfifo_stats_reset(void * data, u64 val);
+static int globalfifo_read_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key);
+static int globalfifo_write_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key);
+static int globalfifo_ring_get(struct globalfifo_dev * dev, char __user * buf, unsigned int size);
+static int globalfifo_ring_put(struct globalfifo_dev * dev, const char __user * buf, unsigned int size);
+static void globalfifo_ring_copy_in(struct globalfifo_dev * dev, const void * src, unsigned int size);
+static int globalfifo_fasync(int fd, struct file * filp, int mode);
+static void globalfifo_notify_readers(struct globalfifo_dev * dev);
+static void globalfifo_notify_writers(struct globalfifo_dev * dev);
+static int globalfifo_set_eventfd(struct globalfifo_file * gf, unsigned int cmd, int fd);
+
+
+/*
+  ** global variable
+*/
+static const struct file_operations globalfifo_fops = {
+  .owner = THIS_MODULE,
+  .llseek = globalfifo_llseek,
+  .read = globalfifo_read,
+  .write = globalfifo_write,
+  .unlocked_ioctl = globalfifo_ioctl,
+  .poll = globalfifo_poll,
+  .fasync = globalfifo_fasync,
+  .open = globalfifo_open,
+  .release = globalfifo_release,
+};
+
+/* debugfs files, defined here so globalfifo_init() can use them */
+DEFINE_SHOW_ATTRIBUTE(globalfifo_stats);
+DEFINE_DEBUGFS_ATTRIBUTE(globalfifo_reset_fops, NULL, globalfifo_stats_reset, "%llu\n");
+
+
+/*
+  ** static global variable
+*/
+static int globalfifo_major = GLOBALFIFO_MAJOR;
+module_param(globalfifo_major, int, S_IRUGO);
+
+/* a full fifo drops its oldest bytes instead of blocking or failing the write */
+static bool globalfifo_overwrite = true;
+module_param(globalfifo_overwrite, bool, S_IRUGO);
+
+struct globalfifo_dev * globalfifo_devp;
+
+
+/* 
+  ** static function list
+*/
+
+/********************************************************************************************
+* Function:    globalfifo_read
+* Description: globalfifo read data
+* Input:       filp: struct file
+*              size: read data size
+*              ppos: pos offset
+* Output:      buf: read buffer
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Read from the ring head instead of shifting the buffer
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Block until the per file rcvlowat is reached
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Sleep as an exclusive waiter
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Signal the write eventfds when space is freed
+             6.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Re-arm the POLL_IN signal of the reading file
+             7.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Count sleeps, time asleep, EAGAIN returns and bytes read
+
+********************************************************************************************/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos)
+{
+  int ret = 0;
+  bool woken = false;
+  u64 start;
+  struct globalfifo_file *gf = filp->private_data;
+  struct globalfifo_dev *dev = gf->dev;
+  struct globalfifo_waiter wait = { .gf = gf };
+
+  init_waitqueue_func_entry(&wait.wq, globalfifo_read_wake);
+  wait.wq.private = current;
+
+  mutex_lock(&dev->mutex);
+  add_wait_queue_exclusive(&dev->r_wait, &wait.wq);
+
+  while(dev->current_len < gf->rcvlowat) {
+    if (filp->f_flags & O_NONBLOCK) {
+      /* like SO_RCVLOWAT a non-blocking read takes whatever is there */
+      if (dev->current_len != 0)
+        break;
+
+      dev->stats.rd_eagain++;
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    dev->stats.rd_sleeps++;
+    start = ktime_get_ns();
+    __set_current_state(TASK_INTERRUPTIBLE);
+    mutex_unlock(&dev->mutex);
+
+    schedule();
+    woken = true;
+    if(signal_pending(current)) {
+      /* do not swallow an exclusive wakeup meant for the next reader */
+      wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+    dev->stats.rd_sleep_ns += ktime_get_ns() - start;
+  }
+
+  if (size > dev->current_len)
+    size = dev->current_len;
+
+  if (globalfifo_ring_get(dev, buf, size)) {
+    ret = -EFAULT;
+    goto out;
+  } else {
+    log_debug("read %d bytes(s), current_len:%d\n", size, dev->current_len);
+    dev->stats.rd_bytes += size;
+
+    /* this file acted on its POLL_IN, the next arrival may signal it again */
+    gf->rd_sig_pending = false;
+
+    if (GLOBALFIFO_SIZE - dev->current_len >= dev->sndlowat_min)
+      wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
+
+    /* only one reader was woken, hand the rest of the data to the next one */
+    if (woken && dev->current_len >= dev->rcvlowat_min)
+      wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
+
+    globalfifo_notify_writers(dev);
+    ret = size;
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+
+out2:
+  remove_wait_queue(&dev->r_wait, &wait.wq);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write
+* Description: globalfifo write data
+* Input:       filp: struct file
+*              buf: write buffer
+*              size: write data size
+*              ppos: pos offset
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Append at the ring tail with wrap-around
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Block until the per file sndlowat is free
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Sleep as an exclusive waiter
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Notify SIGIO and eventfd listeners through globalfifo_notify_readers()
+             6.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Re-arm the POLL_OUT signal of the writing file
+             7.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Count sleeps, time asleep, EAGAIN returns, bytes written and max_len
+             8.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Never split writes of up to gf->atomic bytes
+             9.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Overwrite the oldest bytes instead of blocking when globalfifo_overwrite is set
+             10.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Copy an overwrite mode write in before dropping any bytes, so -EFAULT leaves the ring intact
+
+********************************************************************************************/
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos)
+{
+  int ret = 0;
+  bool woken = false;
+  u64 start;
+  size_t skip = 0;
+  void * kbuf = NULL;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+  struct globalfifo_waiter wait = { .gf = gf, .size = size };
+
+  /*
+   * in overwrite mode the old bytes are dropped before the new ones land, so fetch the
+   * kept tail of the write first: a faulting buffer must not cost the readers any data
+   */
+  if (globalfifo_overwrite) {
+    if (size > GLOBALFIFO_SIZE)
+      skip = size - GLOBALFIFO_SIZE;
+
+    kbuf = memdup_user(buf + skip, size - skip);
+    if (IS_ERR(kbuf))
+      return PTR_ERR(kbuf);
+  }
+
+  init_waitqueue_func_entry(&wait.wq, globalfifo_write_wake);
+  wait.wq.private = current;
+
+  mutex_lock(&dev->mutex);
+  add_wait_queue_exclusive(&dev->w_wait, &wait.wq);
+
+  if (globalfifo_overwrite) {
+    globalfifo_make_room(dev, size);
+    size -= skip;
+  }
+
+  while(!globalfifo_overwrite && GLOBALFIFO_SIZE - dev->current_len < globalfifo_write_need(gf, size)) {
+    if (filp->f_flags & O_NONBLOCK) {
+      /* an atomic write goes in whole or not at all */
+      if (size <= gf->atomic) {
+        if (GLOBALFIFO_SIZE - dev->current_len >= size)
+          break;
+      } else if (dev->current_len != GLOBALFIFO_SIZE) {
+        break;
+      }
+
+      dev->stats.wr_eagain++;
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    dev->stats.wr_sleeps++;
+    start = ktime_get_ns();
+    __set_current_state(TASK_INTERRUPTIBLE);
+
+    mutex_unlock(&dev->mutex);
+    schedule();
+    woken = true;
+
+    if (signal_pending(current)) {
+      wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+    dev->stats.wr_sleep_ns += ktime_get_ns() - start;
+  }
+
+  if (size >= GLOBALFIFO_SIZE - dev->current_len)
+    size = GLOBALFIFO_SIZE - dev->current_len;
+
+  if (kbuf) {
+    globalfifo_ring_copy_in(dev, kbuf, size);
+  } else if (globalfifo_ring_put(dev, buf, size)) {
+    ret = -EFAULT;
+    goto out;
+  }
+
+  log_debug("written %u bytes(s), current_len:%d\n", size, dev->current_len);
+  dev->stats.wr_bytes += size;
+  dev->stats.max_len = max(dev->stats.max_len, dev->current_len);
+
+  gf->wr_sig_pending = false;
+
+  if (dev->current_len >= dev->rcvlowat_min)
+    wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
+
+  if (woken && GLOBALFIFO_SIZE - dev->current_len >= dev->sndlowat_min)
+    wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
+
+  globalfifo_notify_readers(dev);
+
+  /* the skipped head of an oversized write counts as written and dropped */
+  ret = size + skip;
+
+out:
+  mutex_unlock(&dev->mutex);
+out2:
+  remove_wait_queue(&dev->w_wait, &wait.wq);
+  set_current_state(TASK_RUNNING);
+  kfree(kbuf);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_llseek
+* Description: globalfifo llseek pos
+* Input:       filp: struct file
+*              offset: pos offse
+*              orig: pos flag
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig)
+{
+  loff_t ret = 0;
+  switch (orig) {
+  case 0:
+    if (offset < 0) {
+      ret = -EINVAL;
+      break;
+    }
+
+    if((unsigned int)offset > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }
+
+    filp->f_pos = (unsigned int)offset;
+    ret = filp->f_pos;
+    break;
+  case 1:
+    if ((filp->f_pos + offset) > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }  
+
+    if ((filp->f_pos + offset) < 0) {
+      ret = -EINVAL;
+      break;
+    }
+    filp->f_pos += offset;
+    ret = filp->f_pos;
+    break;
+
+  default:
+    ret = -EINVAL;
+    break;
+
+  }
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ioctl
+* Description: globalfifo ioctl
+* Input:       filp: struct file
+*              cmd: command
+*              arg: argue
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_RCVLOWAT_CMD and FIFO_SET_SNDLOWAT_CMD
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_RD_EVENTFD_CMD and FIFO_SET_WR_EVENTFD_CMD
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_ATOMIC_CMD
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_GET_DROPPED_CMD
+
+********************************************************************************************/
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg)
+{
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+  u64 dropped;
+
+  switch (cmd)
+  {
+  case MEM_CLEAR_CMD:
+    memset(dev->mem, 0, GLOBALFIFO_SIZE);
+    log_debug("globalfifo is set to zero\n");
+    break;
+
+  case FIFO_SET_RCVLOWAT_CMD:
+  case FIFO_SET_SNDLOWAT_CMD:
+    /* like SO_RCVLOWAT, 0 means 1 and the watermark cannot exceed the capacity */
+    if (arg > GLOBALFIFO_SIZE)
+      return -EINVAL;
+
+    mutex_lock(&dev->mutex);
+    if (cmd == FIFO_SET_RCVLOWAT_CMD)
+      gf->rcvlowat = max_t(unsigned int, arg, 1);
+    else
+      gf->sndlowat = max_t(unsigned int, arg, 1);
+    globalfifo_update_lowat(dev);
+    mutex_unlock(&dev->mutex);
+
+    /* a lowered watermark may already be satisfied for any of the sleepers */
+    wake_up_interruptible_all(&dev->r_wait);
+    wake_up_interruptible_all(&dev->w_wait);
+    break;
+
+  case FIFO_SET_ATOMIC_CMD:
+    if (arg > GLOBALFIFO_SIZE)
+      return -EINVAL;
+
+    mutex_lock(&dev->mutex);
+    WRITE_ONCE(gf->atomic, arg);
+    mutex_unlock(&dev->mutex);
+
+    /* blocked writes of this file may need less or more space now */
+    wake_up_interruptible_all(&dev->w_wait);
+    break;
+
+  case FIFO_SET_RD_EVENTFD_CMD:
+  case FIFO_SET_WR_EVENTFD_CMD:
+    return globalfifo_set_eventfd(gf, cmd, (int)arg);
+
+  case FIFO_GET_DROPPED_CMD:
+    /* bytes overwritten since this file last asked */
+    mutex_lock(&dev->mutex);
+    dropped = dev->dropped - gf->dropped_seen;
+    gf->dropped_seen = dev->dropped;
+    mutex_unlock(&dev->mutex);
+
+    return put_user(dropped, (u64 __user *)arg);
+  
+  default:
+    return -EINVAL;
+    break;
+  }
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_poll
+* Description: globalfifo poll
+* Input:       filp: struct file
+*              poll_table: poll table pointer
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Report readiness against the per file watermarks
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Compute the mask without dev->mutex
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Report POLLOUT only when an atomic write fits
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Always writable when globalfifo_overwrite is set
+
+********************************************************************************************/
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait)
+{
+  unsigned int mask = 0;
+  unsigned int len;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  poll_wait(filp, &dev->r_wait, wait);
+  poll_wait(filp, &dev->w_wait, wait);
+
+  /*
+    ** no dev->mutex here: poll_wait() queued us under the wait queue lock before the
+    ** load below, and read()/write() update current_len before they take the same
+    ** lock to wake us, so either the new length is seen here or the wakeup finds us.
+    ** Every transition across a watermark issues a wakeup, which keeps EPOLLET safe.
+  */
+  len = READ_ONCE(dev->current_len);
+
+  if (len >= READ_ONCE(gf->rcvlowat)) {
+    mask |= POLLIN | POLLRDNORM;
+  }
+  
+  /* like a pipe, POLLOUT promises room for one atomic write */
+  if (globalfifo_overwrite || GLOBALFIFO_SIZE - len >= globalfifo_write_need(gf, READ_ONCE(gf->atomic))) {
+    mask |= POLLOUT | POLLWRNORM;
+  }
+
+  return mask;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_fasync
+* Description: globalfifo fasync
+* Input:       fd: file descriptor 
+*              filp: struct file
+*              mode: file mode
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Keep the fasync list per open file
+
+********************************************************************************************/
+static int globalfifo_fasync(int fd, struct file * filp, int mode)
+{
+  struct globalfifo_file * gf = filp->private_data;
+
+  return fasync_helper(fd, filp, mode, &gf->async_queue);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_open
+* Description: globalfifo open
+* Input:       inode: inode 
+* Output:      filp: strcut file
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Allocate the per file state
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Start the dropped count of the file at the current total
+
+********************************************************************************************/
+static int globalfifo_open(struct inode * inode, struct file * filp)
+{
+  struct globalfifo_file * gf;
+  struct globalfifo_dev * dev = globalfifo_devp;
+
+  gf = kzalloc(sizeof(struct globalfifo_file), GFP_KERNEL);
+  if (!gf)
+    return -ENOMEM;
+
+  gf->dev = dev;
+  gf->mode = filp->f_mode;
+  gf->rcvlowat = 1;
+  gf->sndlowat = 1;
+
+  mutex_lock(&dev->mutex);
+  gf->dropped_seen = dev->dropped;
+  list_add(&gf->list, &dev->files);
+  globalfifo_update_lowat(dev);
+  mutex_unlock(&dev->mutex);
+
+  filp->private_data = gf;
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_release
+* Description: globalfifo relesase
+* Input:       inode: inode 
+*              filp: strcut file
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Free the per file state
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Drop the registered eventfds
+
+********************************************************************************************/
+static int globalfifo_release(struct inode * inode, struct file *filp)
+{
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  mutex_lock(&dev->mutex);
+  list_del(&gf->list);
+  globalfifo_update_lowat(dev);
+  mutex_unlock(&dev->mutex);
+
+  globalfifo_fasync(-1, filp, 0);
+  if (gf->rd_eventfd)
+    eventfd_ctx_put(gf->rd_eventfd);
+  if (gf->wr_eventfd)
+    eventfd_ctx_put(gf->wr_eventfd);
+  kfree(gf);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_init
+* Description: globalfifo initial
+* Input:       Noen
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Initialize the open file list
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Export the counters through debugfs
+
+********************************************************************************************/
+static int __init globalfifo_init(void)
+{
+    int ret;
+
+    dev_t devno = MKDEV(globalfifo_major, 0);
+    
+    if (globalfifo_major) 
+      ret = register_chrdev_region(devno, 1, "globalfifo");
+    else {
+      ret = alloc_chrdev_region(&devno, 0, 1, "globalfifo");
+      globalfifo_major = MAJOR(devno);
+    }
+
+    if (ret < 0) 
+      return ret;
+
+    globalfifo_devp = kzalloc(sizeof(struct globalfifo_dev), GFP_KERNEL);
+    if (!globalfifo_devp) {
+      ret = -ENOMEM;
+      goto fail_malloc;
+    }
+
+    globalfifo_setup_cdev(globalfifo_devp, 0);
+    mutex_init(&globalfifo_devp->mutex);
+    init_waitqueue_head(&globalfifo_devp->r_wait);
+    init_waitqueue_head(&globalfifo_devp->w_wait);
+    INIT_LIST_HEAD(&globalfifo_devp->files);
+    globalfifo_devp->rcvlowat_min = 1;
+    globalfifo_devp->sndlowat_min = 1;
+
+    /* debugfs is optional, errors are ignored like everywhere else in the kernel */
+    globalfifo_devp->debugfs = debugfs_create_dir("globalfifo", NULL);
+    debugfs_create_file("stats", S_IRUGO, globalfifo_devp->debugfs,
+                        globalfifo_devp, &globalfifo_stats_fops);
+    debugfs_create_file_unsafe("reset", S_IWUSR, globalfifo_devp->debugfs,
+                               globalfifo_devp, &globalfifo_reset_fops);
+
+    return 0; 
+
+fail_malloc:
+    unregister_chrdev_region(devno, 1);
+    return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_exit
+* Description: globalfifo exit
+* Input:       Noen
+* Output:      None
+* Return:      None
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Remove the debugfs directory
+
+********************************************************************************************/
+static void __exit globalfifo_exit(void)
+{
+    debugfs_remove_recursive(globalfifo_devp->debugfs);
+    cdev_del(&globalfifo_devp->cdev);
+    kfree(globalfifo_devp);
+    unregister_chrdev_region(MKDEV(globalfifo_major, 0), 1);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_setup_cdev
+* Description: globalfifo setup cdev struct 
+* Input:       index: cdev index node
+* Output:      dev: initialed cdev 
+* Return:      None
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index)
+{
+  int err, devno = MKDEV(globalfifo_major, index);
+
+  cdev_init(&dev->cdev, &globalfifo_fops);
+  dev->cdev.owner = THIS_MODULE;
+
+  err = cdev_add(&dev->cdev, devno, 1);
+  if (err) 
+    log_debug("Error %d adding globalfifo%d", err, index);
+
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_get
+* Description: copy data out of the ring to user space and advance the head index,
+*              the data may wrap around the end of mem[] so it is copied in two segments
+* Input:       dev: globalfifo device
+*              size: read data size, must not exceed current_len
+* Output:      buf: read buffer
+* Return:      0: execute success
+*              -EFAULT: copy to user failure, the ring is left untouched
+* Others:      caller must hold dev->mutex, current_len is published with WRITE_ONCE()
+*              for the lockless readers in poll and the wake functions
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_ring_get(struct globalfifo_dev * dev, char __user * buf, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->head);
+
+  if (copy_to_user(buf, dev->mem + dev->head, first))
+    return -EFAULT;
+
+  if (copy_to_user(buf + first, dev->mem, size - first))
+    return -EFAULT;
+
+  dev->head = (dev->head + size) & GLOBALFIFO_MASK;
+  WRITE_ONCE(dev->current_len, dev->current_len - size);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_put
+* Description: copy data from user space into the ring and advance the tail index,
+*              the free space may wrap around the end of mem[] so it is filled in two segments
+* Input:       dev: globalfifo device
+*              buf: write buffer
+*              size: write data size, must not exceed the free space
+* Output:      None
+* Return:      0: execute success
+*              -EFAULT: copy from user failure, the ring is left untouched
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_ring_put(struct globalfifo_dev * dev, const char __user * buf, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->tail);
+
+  if (copy_from_user(dev->mem + dev->tail, buf, first))
+    return -EFAULT;
+
+  if (copy_from_user(dev->mem, buf + first, size - first))
+    return -EFAULT;
+
+  dev->tail = (dev->tail + size) & GLOBALFIFO_MASK;
+  WRITE_ONCE(dev->current_len, dev->current_len + size);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_copy_in
+* Description: copy data from a kernel buffer into the ring and advance the tail index
+* Input:       dev: globalfifo device
+*              src: kernel buffer
+*              size: write data size, must not exceed the free space
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_ring_copy_in(struct globalfifo_dev * dev, const void * src, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->tail);
+
+  memcpy(dev->mem + dev->tail, src, first);
+  memcpy(dev->mem, src + first, size - first);
+
+  dev->tail = (dev->tail + size) & GLOBALFIFO_MASK;
+  WRITE_ONCE(dev->current_len, dev->current_len + size);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_update_lowat
+* Description: recompute the smallest low watermarks of the open readers and writers
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. Readers are only woken once current_len reaches
+*              rcvlowat_min and writers once the free space reaches sndlowat_min, no
+*              sleeper can be satisfied below those levels.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_update_lowat(struct globalfifo_dev * dev)
+{
+  struct globalfifo_file * gf;
+
+  dev->rcvlowat_min = GLOBALFIFO_SIZE;
+  dev->sndlowat_min = GLOBALFIFO_SIZE;
+
+  list_for_each_entry(gf, &dev->files, list) {
+    if (gf->mode & FMODE_READ)
+      dev->rcvlowat_min = min(dev->rcvlowat_min, gf->rcvlowat);
+    if (gf->mode & FMODE_WRITE)
+      dev->sndlowat_min = min(dev->sndlowat_min, gf->sndlowat);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_read_wake
+* Description: wake function of a reader sleeping on r_wait
+* Input:       wq: wait queue entry embedded in struct globalfifo_waiter
+*              mode: task state to wake
+*              sync: sync wakeup hint
+*              key: poll mask of the event
+* Output:      None
+* Return:      0: the reader cannot make progress yet and stays asleep
+*              other: the reader was woken
+* Others:      readers sleep as exclusive waiters, so a wakeup is only counted against
+*              the one-reader limit when it goes to a reader whose rcvlowat is reached
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_read_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key)
+{
+  struct globalfifo_waiter * w = container_of(wq, struct globalfifo_waiter, wq);
+
+  if (READ_ONCE(w->gf->dev->current_len) < READ_ONCE(w->gf->rcvlowat))
+    return 0;
+
+  return default_wake_function(wq, mode, sync, key);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write_wake
+* Description: wake function of a writer sleeping on w_wait
+* Input:       wq: wait queue entry embedded in struct globalfifo_waiter
+*              mode: task state to wake
+*              sync: sync wakeup hint
+*              key: poll mask of the event
+* Output:      None
+* Return:      0: the writer cannot make progress yet and stays asleep
+*              other: the writer was woken
+* Others:      mirror of globalfifo_read_wake()
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Wait for the whole of an atomic write
+
+********************************************************************************************/
+static int globalfifo_write_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key)
+{
+  struct globalfifo_waiter * w = container_of(wq, struct globalfifo_waiter, wq);
+
+  if (GLOBALFIFO_SIZE - READ_ONCE(w->gf->dev->current_len) < globalfifo_write_need(w->gf, w->size))
+    return 0;
+
+  return default_wake_function(wq, mode, sync, key);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_notify_readers
+* Description: asynchronous notification that data arrived
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. Every open file whose rcvlowat is reached
+*              gets SIGIO if it enabled FASYNC and an eventfd count if it registered one.
+*              The signal carries POLL_IN, so with F_SETSIG send_sigio() queues the chosen
+*              real-time signal with si_fd and si_band filled in. Real-time signals queue
+*              one entry per kill, so a file is signalled once and then skipped until it
+*              reads or the fifo drops below its rcvlowat again. Writers that were told
+*              POLL_OUT are re-armed once the free space falls below their sndlowat.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Coalesce POLL_IN signals while one is pending
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Re-arm POLL_OUT against the atomic size
+
+********************************************************************************************/
+static void globalfifo_notify_readers(struct globalfifo_dev * dev)
+{
+  struct globalfifo_file * gf;
+
+  list_for_each_entry(gf, &dev->files, list) {
+    if (GLOBALFIFO_SIZE - dev->current_len < globalfifo_write_need(gf, gf->atomic))
+      gf->wr_sig_pending = false;
+
+    if (dev->current_len < gf->rcvlowat)
+      continue;
+
+    if (gf->async_queue && !gf->rd_sig_pending) {
+      gf->rd_sig_pending = true;
+      kill_fasync(&gf->async_queue, SIGIO, POLL_IN);
+      log_debug("%s kill SIGIO\n", __func__);
+    }
+
+    if (gf->rd_eventfd)
+      globalfifo_eventfd_signal(gf->rd_eventfd);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_notify_writers
+* Description: asynchronous notification that space was freed
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. Every open file whose sndlowat is free gets
+*              a POLL_OUT signal if it enabled FASYNC and an eventfd count if it registered
+*              a write eventfd. Signals are coalesced like in globalfifo_notify_readers().
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Send POLL_OUT signals when space is freed
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Wait for room for one atomic write
+
+********************************************************************************************/
+static void globalfifo_notify_writers(struct globalfifo_dev * dev)
+{
+  struct globalfifo_file * gf;
+
+  list_for_each_entry(gf, &dev->files, list) {
+    if (dev->current_len < gf->rcvlowat)
+      gf->rd_sig_pending = false;
+
+    if (GLOBALFIFO_SIZE - dev->current_len < globalfifo_write_need(gf, gf->atomic))
+      continue;
+
+    /* only files open for writing care about free space */
+    if (gf->async_queue && (gf->mode & FMODE_WRITE) && !gf->wr_sig_pending) {
+      gf->wr_sig_pending = true;
+      kill_fasync(&gf->async_queue, SIGIO, POLL_OUT);
+      log_debug("%s kill SIGIO\n", __func__);
+    }
+
+    if (gf->wr_eventfd)
+      globalfifo_eventfd_signal(gf->wr_eventfd);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_set_eventfd
+* Description: register or drop the eventfd of an open file
+* Input:       gf: per file state
+*              cmd: FIFO_SET_RD_EVENTFD_CMD or FIFO_SET_WR_EVENTFD_CMD
+*              fd: eventfd descriptor, negative to drop the registration
+* Output:      None
+* Return:      0: execute success
+*              other: fd is not an eventfd
+* Others:      the eventfd is signalled right away when the condition already holds,
+*              so an edge-triggered event loop does not miss data queued before
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Wait for room for one atomic write
+
+********************************************************************************************/
+static int globalfifo_set_eventfd(struct globalfifo_file * gf, unsigned int cmd, int fd)
+{
+  struct eventfd_ctx * ctx = NULL;
+  struct eventfd_ctx * old;
+  struct globalfifo_dev * dev = gf->dev;
+
+  if (fd >= 0) {
+    ctx = eventfd_ctx_fdget(fd);
+    if (IS_ERR(ctx))
+      return PTR_ERR(ctx);
+  }
+
+  mutex_lock(&dev->mutex);
+  if (cmd == FIFO_SET_RD_EVENTFD_CMD) {
+    old = gf->rd_eventfd;
+    gf->rd_eventfd = ctx;
+    if (ctx && dev->current_len >= gf->rcvlowat)
+      globalfifo_eventfd_signal(ctx);
+  } else {
+    old = gf->wr_eventfd;
+    gf->wr_eventfd = ctx;
+    if (ctx && GLOBALFIFO_SIZE - dev->current_len >= globalfifo_write_need(gf, gf->atomic))
+      globalfifo_eventfd_signal(ctx);
+  }
+  mutex_unlock(&dev->mutex);
+
+  if (old)
+    eventfd_ctx_put(old);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_stats_show
+* Description: print the blocking and occupancy counters
+* Input:       s: seq file of /sys/kernel/debug/globalfifo/stats
+*              unused: seq iterator, not used
+* Output:      None
+* Return:      0: execute success
+* Others:      the counters are copied under dev->mutex so one snapshot is consistent
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Show the total of dropped bytes
+
+********************************************************************************************/
+static int globalfifo_stats_show(struct seq_file * s, void * unused)
+{
+  struct globalfifo_dev * dev = s->private;
+  struct globalfifo_stats st;
+  unsigned int len;
+  u64 dropped;
+
+  mutex_lock(&dev->mutex);
+  st = dev->stats;
+  len = dev->current_len;
+  dropped = dev->dropped;
+  mutex_unlock(&dev->mutex);
+
+  seq_printf(s, "size:        %u\n", GLOBALFIFO_SIZE);
+  seq_printf(s, "current_len: %u\n", len);
+  seq_printf(s, "max_len:     %u\n", st.max_len);
+  seq_printf(s, "rd_bytes:    %llu\n", st.rd_bytes);
+  seq_printf(s, "rd_sleeps:   %llu\n", st.rd_sleeps);
+  seq_printf(s, "rd_sleep_ns: %llu\n", st.rd_sleep_ns);
+  seq_printf(s, "rd_eagain:   %llu\n", st.rd_eagain);
+  seq_printf(s, "wr_bytes:    %llu\n", st.wr_bytes);
+  seq_printf(s, "wr_sleeps:   %llu\n", st.wr_sleeps);
+  seq_printf(s, "wr_sleep_ns: %llu\n", st.wr_sleep_ns);
+  seq_printf(s, "wr_eagain:   %llu\n", st.wr_eagain);
+  seq_printf(s, "dropped:     %llu\n", dropped);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_stats_reset
+* Description: clear the counters, any value written to debugfs reset does it
+* Input:       data: globalfifo device
+*              val: written value, ignored
+* Output:      None
+* Return:      0: execute success
+* Others:      max_len restarts from the current occupancy
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_stats_reset(void * data, u64 val)
+{
+  struct globalfifo_dev * dev = data;
+
+  mutex_lock(&dev->mutex);
+  memset(&dev->stats, 0, sizeof(dev->stats));
+  dev->stats.max_len = dev->current_len;
+  mutex_unlock(&dev->mutex);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write_need
+* Description: free space a write of this file has to wait for
+* Input:       gf: per file state
+*              size: write data size
+* Output:      None
+* Return:      unsigned int: free bytes needed
+* Others:      lockless. A write of at most gf->atomic bytes waits until it fits entirely,
+*              any other write only until sndlowat bytes are free.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static unsigned int globalfifo_write_need(struct globalfifo_file * gf, size_t size)
+{
+  unsigned int need = READ_ONCE(gf->sndlowat);
+
+  if (size <= READ_ONCE(gf->atomic))
+    need = max_t(unsigned int, need, size);
+
+  return need;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_make_room
+* Description: drop the oldest bytes until a write of size bytes fits
+* Input:       dev: globalfifo device
+*              size: write data size
+* Output:      None
+* Return:      size_t: leading bytes of the write to skip, only the newest GLOBALFIFO_SIZE
+*              bytes of a larger write can be kept
+* Others:      caller must hold dev->mutex and must already have copied in the data,
+*              the write can no longer fail once bytes are dropped. Dropped and skipped
+*              bytes are both added to dev->dropped.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Only called once the write data is safely in a kernel buffer
+
+********************************************************************************************/
+static size_t globalfifo_make_room(struct globalfifo_dev * dev, size_t size)
+{
+  size_t skip = 0;
+  unsigned int drop = 0;
+
+  if (size > GLOBALFIFO_SIZE) {
+    skip = size - GLOBALFIFO_SIZE;
+    size = GLOBALFIFO_SIZE;
+  }
+
+  if (GLOBALFIFO_SIZE - dev->current_len < size) {
+    drop = size - (GLOBALFIFO_SIZE - dev->current_len);
+    dev->head = (dev->head + drop) & GLOBALFIFO_MASK;
+    WRITE_ONCE(dev->current_len, dev->current_len - drop);
+  }
+
+  dev->dropped += skip + drop;
+
+  return skip;
+}
+
+
+/*
+  ** module declaration
+*/
+module_init(globalfifo_init);
+module_exit(globalfifo_exit);
+
+MODULE_AUTHOR("JexJiang");
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("A simple Hello World Module");
+MODULE_ALIAS("a simplest module");
+MODULE_VERSION("v1.0");
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
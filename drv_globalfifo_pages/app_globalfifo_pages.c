@@ -0,0 +1,137 @@
+/*
+  ** @file           : app_globalfifo_pages.c
+  ** @brief          : global fifo page chain application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   STATS_PATH                  "/sys/kernel/debug/globalfifo/stats"
+#define   BURST_SIZE                  (48 * 1024)
+#define   BURST_COUNT                 (1000)
+
+
+/*
+  ** static global variable
+*/
+static char buf[BURST_SIZE];
+
+
+/********************************************************************************************
+* Function:    show_pages
+* Description: print the chain, pool and page allocator lines of the debugfs stats
+* Input:       tag: text printed before the lines
+* Output:      None
+* Return:      None
+* Others:      needs root and a mounted debugfs
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void show_pages(const char * tag)
+{
+  char line[64];
+  FILE * fp = fopen(STATS_PATH, "r");
+
+  if (!fp) {
+    perror(STATS_PATH);
+    return;
+  }
+
+  printf("%s:\n", tag);
+  while (fgets(line, sizeof(line), fp)) {
+    if (!strncmp(line, "page", 4) || !strncmp(line, "pool", 4))
+      printf("  %s", line);
+  }
+
+  fclose(fp);
+}
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list, not used
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      pushes BURST_COUNT bursts through the fifo, page_allocs should only grow
+*              during the first burst
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+int main(int argc, char * argv[])
+{
+    int fd, i;
+    ssize_t len, done;
+
+    fd = open("/dev/globalfifo", O_RDWR | O_NONBLOCK);
+    if (-1 == fd) {
+        log_debug("/dev/globalfifo open failure\r\n");
+        return -1;
+    }
+
+    show_pages("before");
+
+    for (i = 0; i < BURST_COUNT; i++) {
+        for (done = 0; done < BURST_SIZE; done += len) {
+            len = write(fd, buf + done, BURST_SIZE - done);
+            if (len <= 0) {
+                perror("write()");
+                return -1;
+            }
+        }
+
+        for (done = 0; done < BURST_SIZE; done += len) {
+            len = read(fd, buf + done, BURST_SIZE - done);
+            if (len <= 0) {
+                perror("read()");
+                return -1;
+            }
+        }
+
+        if (0 == i)
+            show_pages("after the first burst");
+    }
+
+    show_pages("after all bursts");
+    sleep(3);
+    show_pages("after 3s idle");
+
+    close(fd);
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
@@ -0,0 +1,1520 @@
+/*
+  ** @file           : drv_globalfifo_pages.c
+  ** @brief          : global fifo page chain driver source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/cdev.h>
+#include <linux/kern_levels.h>
+#include <linux/printk.h>
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/sched/signal.h>
+#include <linux/memory.h>
+#include <linux/poll.h>
+#include <linux/timekeeping.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/eventfd.h>
+#include <linux/version.h>
+#include <linux/mm.h>
+#include <linux/workqueue.h>
+
+
+/*
+  ** define
+*/
+#define     GLOBALFIFO_PAGES        (16)
+#define     GLOBALFIFO_SIZE         ((unsigned int)(GLOBALFIFO_PAGES * PAGE_SIZE))
+#define     GLOBALFIFO_POOL_MIN     (2)
+#define     GLOBALFIFO_IDLE         (HZ)
+#define     MEM_CLEAR_CMD           (0x1)
+#define     FIFO_SET_RCVLOWAT_CMD   (0x2)
+#define     FIFO_SET_SNDLOWAT_CMD   (0x3)
+#define     FIFO_SET_RD_EVENTFD_CMD (0x4)
+#define     FIFO_SET_WR_EVENTFD_CMD (0x5)
+#define     FIFO_SET_ATOMIC_CMD     (0x6)
+#define     GLOBALFIFO_MAJOR        (230)
+
+#define     log_debug(fmt, ...)     printk(KERN_DEBUG   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_info(fmt, ...)      printk(KERN_INFO    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_notice(fmt, ...)    printk(KERN_NOTICE  pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_warning(fmt, ...)   printk(KERN_WARNING pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_err(fmt, ...)       printk(KERN_ERR     pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_crit(fmt, ...)      printk(KERN_CRIT    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_alert(fmt, ...)     printk(KERN_ALERT   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_emerg(fmt, ...)     printk(KERN_EMERG   pr_fmt(fmt), ##__VA_ARGS__)
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 8, 0)
+#define     globalfifo_eventfd_signal(ctx)  eventfd_signal(ctx)
+#else
+#define     globalfifo_eventfd_signal(ctx)  eventfd_signal(ctx, 1)
+#endif
+
+
+/*
+  ** struct
+*/
+
+/*
+  ** counters exported through /sys/kernel/debug/globalfifo/stats, all protected by
+  ** dev->mutex. A sleep is counted when it starts, its time once the sleeper holds
+  ** the mutex again, so a sleep cut short by a signal adds no time.
+*/
+struct globalfifo_stats {
+  u64 rd_bytes;
+  u64 rd_sleeps;
+  u64 rd_sleep_ns;
+  u64 rd_eagain;
+  u64 wr_bytes;
+  u64 wr_sleeps;
+  u64 wr_sleep_ns;
+  u64 wr_eagain;
+  u64 page_allocs;
+  u64 page_frees;
+  unsigned int max_len;
+};
+
+/*
+  ** the data lives in a chain of pages linked through page->lru: it starts head bytes
+  ** into the first page and ends tail bytes into the last one. Consumed pages move to
+  ** the pool and are reused by the next writes, shrink_work frees spare pool pages
+  ** once the fifo has been idle for GLOBALFIFO_IDLE. GLOBALFIFO_SIZE only caps
+  ** current_len, an idle empty fifo holds GLOBALFIFO_POOL_MIN pages.
+*/
+
+struct globalfifo_dev {
+  struct cdev cdev;
+  unsigned int current_len;
+  unsigned int head;
+  unsigned int tail;
+  struct list_head chain;
+  unsigned int nr_pages;
+  struct list_head pool;
+  unsigned int pool_len;
+  unsigned long last_use;
+  struct delayed_work shrink_work;
+  struct mutex mutex;
+  wait_queue_head_t r_wait;
+  wait_queue_head_t w_wait;
+  struct list_head files;
+  unsigned int rcvlowat_min;
+  unsigned int sndlowat_min;
+  struct globalfifo_stats stats;
+  struct dentry * debugfs;
+};
+
+/*
+  ** per open file state, rcvlowat/sndlowat are the low watermarks of this file:
+  ** a read blocks and POLLIN stays clear until rcvlowat bytes are buffered, a write
+  ** blocks and POLLOUT stays clear until sndlowat bytes are free, SIGIO is only sent
+  ** to this file once rcvlowat bytes are buffered. rd_eventfd/wr_eventfd are signalled
+  ** under the same watermarks when data arrives or space is freed.
+  ** rd_sig_pending/wr_sig_pending mark a POLL_IN/POLL_OUT signal that was sent and not
+  ** yet acted upon, see globalfifo_notify_readers().
+  ** atomic works like PIPE_BUF: a write of up to atomic bytes is never split, 0 turns it off.
+  ** POLLOUT, POLL_OUT and the write eventfd then also wait for atomic free bytes.
+*/
+struct globalfifo_file {
+  struct globalfifo_dev * dev;
+  struct list_head list;
+  fmode_t mode;
+  unsigned int rcvlowat;
+  unsigned int sndlowat;
+  unsigned int atomic;
+  struct fasync_struct * async_queue;
+  struct eventfd_ctx * rd_eventfd;
+  struct eventfd_ctx * wr_eventfd;
+  bool rd_sig_pending;
+  bool wr_sig_pending;
+};
+
+/*
+  ** wait queue entry of a blocked reader or writer, see globalfifo_read_wake(),
+  ** size is the length of a blocked write
+*/
+struct globalfifo_waiter {
+  wait_queue_entry_t wq;
+  struct globalfifo_file * gf;
+  size_t size;
+};
+
+
+/*
+  ** static function declaration
+*/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos);
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos);
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig);
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg);
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait);
+static int globalfifo_open(struct inode * inode, struct file * filp);
+static int globalfifo_release(struct inode * inode, struct file *filp);
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index);
+static void globalfifo_update_lowat(struct globalfifo_dev * dev);
+static unsigned int globalfifo_write_need(struct globalfifo_file * gf, size_t size);
+static int globalfifo_stats_show(struct seq_file * s, void * unused);
+static int globalfifo_stats_reset(void * data, u64 val);
+static int globalfifo_read_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key);
+static int globalfifo_write_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key);
+static int globalfifo_ring_get(struct globalfifo_dev * dev, char __user * buf, unsigned int size);
+static int globalfifo_ring_put(struct globalfifo_dev * dev, const char __user * buf, unsigned int size);
+static struct page * globalfifo_page_get(struct globalfifo_dev * dev);
+static void globalfifo_page_put(struct globalfifo_dev * dev, struct page * page);
+static void globalfifo_pool_shrink(struct work_struct * work);
+static void globalfifo_free_pages(struct list_head * list);
+static int globalfifo_fasync(int fd, struct file * filp, int mode);
+static void globalfifo_notify_readers(struct globalfifo_dev * dev);
+static void globalfifo_notify_writers(struct globalfifo_dev * dev);
+static int globalfifo_set_eventfd(struct globalfifo_file * gf, unsigned int cmd, int fd);
+
+
+/*
+  ** global variable
+*/
+static const struct file_operations globalfifo_fops = {
+  .owner = THIS_MODULE,
+  .llseek = globalfifo_llseek,
+  .read = globalfifo_read,
+  .write = globalfifo_write,
+  .unlocked_ioctl = globalfifo_ioctl,
+  .poll = globalfifo_poll,
+  .fasync = globalfifo_fasync,
+  .open = globalfifo_open,
+  .release = globalfifo_release,
+};
+
+/* debugfs files, defined here so globalfifo_init() can use them */
+DEFINE_SHOW_ATTRIBUTE(globalfifo_stats);
+DEFINE_DEBUGFS_ATTRIBUTE(globalfifo_reset_fops, NULL, globalfifo_stats_reset, "%llu\n");
+
+
+/*
+  ** static global variable
+*/
+static int globalfifo_major = GLOBALFIFO_MAJOR;
+module_param(globalfifo_major, int, S_IRUGO);
+
+struct globalfifo_dev * globalfifo_devp;
+
+
+/* 
+  ** static function list
+*/
+
+/********************************************************************************************
+* Function:    globalfifo_read
+* Description: globalfifo read data
+* Input:       filp: struct file
+*              size: read data size
+*              ppos: pos offset
+* Output:      buf: read buffer
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Read from the ring head instead of shifting the buffer
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Block until the per file rcvlowat is reached
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Sleep as an exclusive waiter
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Signal the write eventfds when space is freed
+             6.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Re-arm the POLL_IN signal of the reading file
+             7.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Count sleeps, time asleep, EAGAIN returns and bytes read
+
+********************************************************************************************/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos)
+{
+  int ret = 0;
+  bool woken = false;
+  u64 start;
+  struct globalfifo_file *gf = filp->private_data;
+  struct globalfifo_dev *dev = gf->dev;
+  struct globalfifo_waiter wait = { .gf = gf };
+
+  init_waitqueue_func_entry(&wait.wq, globalfifo_read_wake);
+  wait.wq.private = current;
+
+  mutex_lock(&dev->mutex);
+  add_wait_queue_exclusive(&dev->r_wait, &wait.wq);
+
+  while(dev->current_len < gf->rcvlowat) {
+    if (filp->f_flags & O_NONBLOCK) {
+      /* like SO_RCVLOWAT a non-blocking read takes whatever is there */
+      if (dev->current_len != 0)
+        break;
+
+      dev->stats.rd_eagain++;
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    dev->stats.rd_sleeps++;
+    start = ktime_get_ns();
+    __set_current_state(TASK_INTERRUPTIBLE);
+    mutex_unlock(&dev->mutex);
+
+    schedule();
+    woken = true;
+    if(signal_pending(current)) {
+      /* do not swallow an exclusive wakeup meant for the next reader */
+      wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+    dev->stats.rd_sleep_ns += ktime_get_ns() - start;
+  }
+
+  if (size > dev->current_len)
+    size = dev->current_len;
+
+  if (globalfifo_ring_get(dev, buf, size)) {
+    ret = -EFAULT;
+    goto out;
+  } else {
+    log_debug("read %d bytes(s), current_len:%d\n", size, dev->current_len);
+    dev->stats.rd_bytes += size;
+
+    /* this file acted on its POLL_IN, the next arrival may signal it again */
+    gf->rd_sig_pending = false;
+
+    if (GLOBALFIFO_SIZE - dev->current_len >= dev->sndlowat_min)
+      wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
+
+    /* only one reader was woken, hand the rest of the data to the next one */
+    if (woken && dev->current_len >= dev->rcvlowat_min)
+      wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
+
+    globalfifo_notify_writers(dev);
+    ret = size;
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+
+out2:
+  remove_wait_queue(&dev->r_wait, &wait.wq);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write
+* Description: globalfifo write data
+* Input:       filp: struct file
+*              buf: write buffer
+*              size: write data size
+*              ppos: pos offset
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Append at the ring tail with wrap-around
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Block until the per file sndlowat is free
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Sleep as an exclusive waiter
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Notify SIGIO and eventfd listeners through globalfifo_notify_readers()
+             6.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Re-arm the POLL_OUT signal of the writing file
+             7.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Count sleeps, time asleep, EAGAIN returns, bytes written and max_len
+             8.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Never split writes of up to gf->atomic bytes
+             9.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Return -ENOMEM when the chain cannot grow
+
+********************************************************************************************/
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos)
+{
+  int ret = 0;
+  bool woken = false;
+  u64 start;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+  struct globalfifo_waiter wait = { .gf = gf, .size = size };
+
+  init_waitqueue_func_entry(&wait.wq, globalfifo_write_wake);
+  wait.wq.private = current;
+
+  mutex_lock(&dev->mutex);
+  add_wait_queue_exclusive(&dev->w_wait, &wait.wq);
+
+  while(GLOBALFIFO_SIZE - dev->current_len < globalfifo_write_need(gf, size)) {
+    if (filp->f_flags & O_NONBLOCK) {
+      /* an atomic write goes in whole or not at all */
+      if (size <= gf->atomic) {
+        if (GLOBALFIFO_SIZE - dev->current_len >= size)
+          break;
+      } else if (dev->current_len != GLOBALFIFO_SIZE) {
+        break;
+      }
+
+      dev->stats.wr_eagain++;
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    dev->stats.wr_sleeps++;
+    start = ktime_get_ns();
+    __set_current_state(TASK_INTERRUPTIBLE);
+
+    mutex_unlock(&dev->mutex);
+    schedule();
+    woken = true;
+
+    if (signal_pending(current)) {
+      wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+    dev->stats.wr_sleep_ns += ktime_get_ns() - start;
+  }
+
+  if (size >= GLOBALFIFO_SIZE - dev->current_len)
+    size = GLOBALFIFO_SIZE - dev->current_len;
+
+  ret = globalfifo_ring_put(dev, buf, size);
+  if (ret) {
+    goto out;
+  } else {
+    log_debug("written %u bytes(s), current_len:%d\n", size, dev->current_len);
+    dev->stats.wr_bytes += size;
+    dev->stats.max_len = max(dev->stats.max_len, dev->current_len);
+
+    gf->wr_sig_pending = false;
+
+    if (dev->current_len >= dev->rcvlowat_min)
+      wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
+
+    if (woken && GLOBALFIFO_SIZE - dev->current_len >= dev->sndlowat_min)
+      wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
+
+    globalfifo_notify_readers(dev);
+
+    ret = size;
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+out2:
+  remove_wait_queue(&dev->w_wait, &wait.wq);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_llseek
+* Description: globalfifo llseek pos
+* Input:       filp: struct file
+*              offset: pos offse
+*              orig: pos flag
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig)
+{
+  loff_t ret = 0;
+  switch (orig) {
+  case 0:
+    if (offset < 0) {
+      ret = -EINVAL;
+      break;
+    }
+
+    if((unsigned int)offset > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }
+
+    filp->f_pos = (unsigned int)offset;
+    ret = filp->f_pos;
+    break;
+  case 1:
+    if ((filp->f_pos + offset) > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }  
+
+    if ((filp->f_pos + offset) < 0) {
+      ret = -EINVAL;
+      break;
+    }
+    filp->f_pos += offset;
+    ret = filp->f_pos;
+    break;
+
+  default:
+    ret = -EINVAL;
+    break;
+
+  }
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ioctl
+* Description: globalfifo ioctl
+* Input:       filp: struct file
+*              cmd: command
+*              arg: argue
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_RCVLOWAT_CMD and FIFO_SET_SNDLOWAT_CMD
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_RD_EVENTFD_CMD and FIFO_SET_WR_EVENTFD_CMD
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_ATOMIC_CMD
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: MEM_CLEAR_CMD clears the pages of the chain
+
+********************************************************************************************/
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg)
+{
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+  struct page * page;
+
+  switch (cmd)
+  {
+  case MEM_CLEAR_CMD:
+    mutex_lock(&dev->mutex);
+    list_for_each_entry(page, &dev->chain, lru)
+      memset(page_address(page), 0, PAGE_SIZE);
+    mutex_unlock(&dev->mutex);
+    log_debug("globalfifo is set to zero\n");
+    break;
+
+  case FIFO_SET_RCVLOWAT_CMD:
+  case FIFO_SET_SNDLOWAT_CMD:
+    /* like SO_RCVLOWAT, 0 means 1 and the watermark cannot exceed the capacity */
+    if (arg > GLOBALFIFO_SIZE)
+      return -EINVAL;
+
+    mutex_lock(&dev->mutex);
+    if (cmd == FIFO_SET_RCVLOWAT_CMD)
+      gf->rcvlowat = max_t(unsigned int, arg, 1);
+    else
+      gf->sndlowat = max_t(unsigned int, arg, 1);
+    globalfifo_update_lowat(dev);
+    mutex_unlock(&dev->mutex);
+
+    /* a lowered watermark may already be satisfied for any of the sleepers */
+    wake_up_interruptible_all(&dev->r_wait);
+    wake_up_interruptible_all(&dev->w_wait);
+    break;
+
+  case FIFO_SET_ATOMIC_CMD:
+    if (arg > GLOBALFIFO_SIZE)
+      return -EINVAL;
+
+    mutex_lock(&dev->mutex);
+    WRITE_ONCE(gf->atomic, arg);
+    mutex_unlock(&dev->mutex);
+
+    /* blocked writes of this file may need less or more space now */
+    wake_up_interruptible_all(&dev->w_wait);
+    break;
+
+  case FIFO_SET_RD_EVENTFD_CMD:
+  case FIFO_SET_WR_EVENTFD_CMD:
+    return globalfifo_set_eventfd(gf, cmd, (int)arg);
+  
+  default:
+    return -EINVAL;
+    break;
+  }
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_poll
+* Description: globalfifo poll
+* Input:       filp: struct file
+*              poll_table: poll table pointer
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Report readiness against the per file watermarks
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Compute the mask without dev->mutex
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Report POLLOUT only when an atomic write fits
+
+********************************************************************************************/
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait)
+{
+  unsigned int mask = 0;
+  unsigned int len;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  poll_wait(filp, &dev->r_wait, wait);
+  poll_wait(filp, &dev->w_wait, wait);
+
+  /*
+    ** no dev->mutex here: poll_wait() queued us under the wait queue lock before the
+    ** load below, and read()/write() update current_len before they take the same
+    ** lock to wake us, so either the new length is seen here or the wakeup finds us.
+    ** Every transition across a watermark issues a wakeup, which keeps EPOLLET safe.
+  */
+  len = READ_ONCE(dev->current_len);
+
+  if (len >= READ_ONCE(gf->rcvlowat)) {
+    mask |= POLLIN | POLLRDNORM;
+  }
+  
+  /* like a pipe, POLLOUT promises room for one atomic write */
+  if (GLOBALFIFO_SIZE - len >= globalfifo_write_need(gf, READ_ONCE(gf->atomic))) {
+    mask |= POLLOUT | POLLWRNORM;
+  }
+
+  return mask;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_fasync
+* Description: globalfifo fasync
+* Input:       fd: file descriptor 
+*              filp: struct file
+*              mode: file mode
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Keep the fasync list per open file
+
+********************************************************************************************/
+static int globalfifo_fasync(int fd, struct file * filp, int mode)
+{
+  struct globalfifo_file * gf = filp->private_data;
+
+  return fasync_helper(fd, filp, mode, &gf->async_queue);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_open
+* Description: globalfifo open
+* Input:       inode: inode 
+* Output:      filp: strcut file
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Allocate the per file state
+
+********************************************************************************************/
+static int globalfifo_open(struct inode * inode, struct file * filp)
+{
+  struct globalfifo_file * gf;
+  struct globalfifo_dev * dev = globalfifo_devp;
+
+  gf = kzalloc(sizeof(struct globalfifo_file), GFP_KERNEL);
+  if (!gf)
+    return -ENOMEM;
+
+  gf->dev = dev;
+  gf->mode = filp->f_mode;
+  gf->rcvlowat = 1;
+  gf->sndlowat = 1;
+
+  mutex_lock(&dev->mutex);
+  list_add(&gf->list, &dev->files);
+  globalfifo_update_lowat(dev);
+  mutex_unlock(&dev->mutex);
+
+  filp->private_data = gf;
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_release
+* Description: globalfifo relesase
+* Input:       inode: inode 
+*              filp: strcut file
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Free the per file state
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Drop the registered eventfds
+
+********************************************************************************************/
+static int globalfifo_release(struct inode * inode, struct file *filp)
+{
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  mutex_lock(&dev->mutex);
+  list_del(&gf->list);
+  globalfifo_update_lowat(dev);
+  mutex_unlock(&dev->mutex);
+
+  globalfifo_fasync(-1, filp, 0);
+  if (gf->rd_eventfd)
+    eventfd_ctx_put(gf->rd_eventfd);
+  if (gf->wr_eventfd)
+    eventfd_ctx_put(gf->wr_eventfd);
+  kfree(gf);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_init
+* Description: globalfifo initial
+* Input:       Noen
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Initialize the open file list
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Export the counters through debugfs
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Initialize the page chain, pool and shrink work
+
+********************************************************************************************/
+static int __init globalfifo_init(void)
+{
+    int ret;
+
+    dev_t devno = MKDEV(globalfifo_major, 0);
+    
+    if (globalfifo_major) 
+      ret = register_chrdev_region(devno, 1, "globalfifo");
+    else {
+      ret = alloc_chrdev_region(&devno, 0, 1, "globalfifo");
+      globalfifo_major = MAJOR(devno);
+    }
+
+    if (ret < 0) 
+      return ret;
+
+    globalfifo_devp = kzalloc(sizeof(struct globalfifo_dev), GFP_KERNEL);
+    if (!globalfifo_devp) {
+      ret = -ENOMEM;
+      goto fail_malloc;
+    }
+
+    globalfifo_setup_cdev(globalfifo_devp, 0);
+    mutex_init(&globalfifo_devp->mutex);
+    init_waitqueue_head(&globalfifo_devp->r_wait);
+    init_waitqueue_head(&globalfifo_devp->w_wait);
+    INIT_LIST_HEAD(&globalfifo_devp->files);
+    INIT_LIST_HEAD(&globalfifo_devp->chain);
+    INIT_LIST_HEAD(&globalfifo_devp->pool);
+    INIT_DELAYED_WORK(&globalfifo_devp->shrink_work, globalfifo_pool_shrink);
+    globalfifo_devp->rcvlowat_min = 1;
+    globalfifo_devp->sndlowat_min = 1;
+
+    /* debugfs is optional, errors are ignored like everywhere else in the kernel */
+    globalfifo_devp->debugfs = debugfs_create_dir("globalfifo", NULL);
+    debugfs_create_file("stats", S_IRUGO, globalfifo_devp->debugfs,
+                        globalfifo_devp, &globalfifo_stats_fops);
+    debugfs_create_file_unsafe("reset", S_IWUSR, globalfifo_devp->debugfs,
+                               globalfifo_devp, &globalfifo_reset_fops);
+
+    return 0; 
+
+fail_malloc:
+    unregister_chrdev_region(devno, 1);
+    return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_exit
+* Description: globalfifo exit
+* Input:       Noen
+* Output:      None
+* Return:      None
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Remove the debugfs directory
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Stop the shrink work and free the chain and pool
+
+********************************************************************************************/
+static void __exit globalfifo_exit(void)
+{
+    debugfs_remove_recursive(globalfifo_devp->debugfs);
+    cdev_del(&globalfifo_devp->cdev);
+    cancel_delayed_work_sync(&globalfifo_devp->shrink_work);
+    globalfifo_free_pages(&globalfifo_devp->chain);
+    globalfifo_free_pages(&globalfifo_devp->pool);
+    kfree(globalfifo_devp);
+    unregister_chrdev_region(MKDEV(globalfifo_major, 0), 1);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_setup_cdev
+* Description: globalfifo setup cdev struct 
+* Input:       index: cdev index node
+* Output:      dev: initialed cdev 
+* Return:      None
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index)
+{
+  int err, devno = MKDEV(globalfifo_major, index);
+
+  cdev_init(&dev->cdev, &globalfifo_fops);
+  dev->cdev.owner = THIS_MODULE;
+
+  err = cdev_add(&dev->cdev, devno, 1);
+  if (err) 
+    log_debug("Error %d adding globalfifo%d", err, index);
+
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_get
+* Description: copy data out of the page chain to user space and advance the head offset,
+*              pages that are fully consumed go back to the pool
+* Input:       dev: globalfifo device
+*              size: read data size, must not exceed current_len
+* Output:      buf: read buffer
+* Return:      0: execute success
+*              -EFAULT: copy to user failure, the chain is left untouched
+* Others:      caller must hold dev->mutex, current_len is published with WRITE_ONCE()
+*              for the lockless readers in poll and the wake functions
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Walk the page chain instead of a contiguous buffer
+
+********************************************************************************************/
+static int globalfifo_ring_get(struct globalfifo_dev * dev, char __user * buf, unsigned int size)
+{
+  struct page * page, * tmp;
+  unsigned int chunk, off = dev->head, done = 0;
+
+  /* copy everything first so a fault does not consume anything */
+  list_for_each_entry(page, &dev->chain, lru) {
+    if (done == size)
+      break;
+
+    chunk = min_t(unsigned int, size - done, PAGE_SIZE - off);
+    if (copy_to_user(buf + done, page_address(page) + off, chunk))
+      return -EFAULT;
+
+    done += chunk;
+    off = 0;
+  }
+
+  done = size;
+  list_for_each_entry_safe(page, tmp, &dev->chain, lru) {
+    chunk = min_t(unsigned int, done, PAGE_SIZE - dev->head);
+    dev->head += chunk;
+    done -= chunk;
+
+    /* a page is finished when it is read to its end, or it is the last one and empty */
+    if (dev->head == PAGE_SIZE ||
+        (list_is_last(&page->lru, &dev->chain) && dev->head == dev->tail)) {
+      list_del(&page->lru);
+      dev->nr_pages--;
+      globalfifo_page_put(dev, page);
+      dev->head = 0;
+    }
+
+    if (!done)
+      break;
+  }
+
+  dev->last_use = jiffies;
+  WRITE_ONCE(dev->current_len, dev->current_len - size);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_put
+* Description: copy data from user space to the end of the page chain and advance the tail
+*              offset, a page is taken from the pool whenever the last one is full
+* Input:       dev: globalfifo device
+*              buf: write buffer
+*              size: write data size, must not exceed the free space
+* Output:      None
+* Return:      0: execute success
+*              -EFAULT: copy from user failure, the chain is left untouched
+*              -ENOMEM: the pool is empty and no page could be allocated
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Append to the page chain, growing it from the pool
+
+********************************************************************************************/
+static int globalfifo_ring_put(struct globalfifo_dev * dev, const char __user * buf, unsigned int size)
+{
+  int ret;
+  struct page * page;
+  unsigned int chunk, done = 0, tail = dev->tail, nr_pages = dev->nr_pages;
+
+  while (done < size) {
+    if (!dev->nr_pages || dev->tail == PAGE_SIZE) {
+      page = globalfifo_page_get(dev);
+      if (!page) {
+        ret = -ENOMEM;
+        goto fail;
+      }
+
+      if (!dev->nr_pages)
+        dev->head = 0;
+      list_add_tail(&page->lru, &dev->chain);
+      dev->nr_pages++;
+      dev->tail = 0;
+    }
+
+    page = list_last_entry(&dev->chain, struct page, lru);
+    chunk = min_t(unsigned int, size - done, PAGE_SIZE - dev->tail);
+    if (copy_from_user(page_address(page) + dev->tail, buf + done, chunk)) {
+      ret = -EFAULT;
+      goto fail;
+    }
+
+    dev->tail += chunk;
+    done += chunk;
+  }
+
+  dev->last_use = jiffies;
+  WRITE_ONCE(dev->current_len, dev->current_len + size);
+
+  return 0;
+
+fail:
+  /* give back the pages this call added, the bytes copied into them were never published */
+  while (dev->nr_pages > nr_pages) {
+    page = list_last_entry(&dev->chain, struct page, lru);
+    list_del(&page->lru);
+    dev->nr_pages--;
+    globalfifo_page_put(dev, page);
+  }
+  dev->tail = tail;
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_page_get
+* Description: take a page for the chain, from the pool when it has one
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      struct page *: the page
+*              NULL: the pool is empty and the allocation failed
+* Others:      caller must hold dev->mutex. The page allocator is only called when the
+*              fifo grows beyond what it held before, a steady load is served by the pool.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static struct page * globalfifo_page_get(struct globalfifo_dev * dev)
+{
+  struct page * page;
+
+  if (dev->pool_len) {
+    page = list_first_entry(&dev->pool, struct page, lru);
+    list_del(&page->lru);
+    dev->pool_len--;
+    return page;
+  }
+
+  page = alloc_page(GFP_KERNEL);
+  if (page)
+    dev->stats.page_allocs++;
+
+  return page;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_page_put
+* Description: return a consumed page to the pool
+* Input:       dev: globalfifo device
+*              page: page taken off the chain
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. The page goes to the front of the pool so the
+*              next globalfifo_page_get() reuses the cache hot one. Spare pages above
+*              GLOBALFIFO_POOL_MIN arm the idle shrinker.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_page_put(struct globalfifo_dev * dev, struct page * page)
+{
+  list_add(&page->lru, &dev->pool);
+  dev->pool_len++;
+
+  /* does nothing while the work is already pending */
+  if (dev->pool_len > GLOBALFIFO_POOL_MIN)
+    schedule_delayed_work(&dev->shrink_work, GLOBALFIFO_IDLE);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_pool_shrink
+* Description: free spare pool pages once the fifo has been idle for GLOBALFIFO_IDLE
+* Input:       work: shrink_work of the globalfifo device
+* Output:      None
+* Return:      None
+* Others:      half of the spare pages above GLOBALFIFO_POOL_MIN go per idle period so a
+*              short pause does not throw away the whole working set. Pages are freed
+*              after dev->mutex is dropped.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_pool_shrink(struct work_struct * work)
+{
+  struct globalfifo_dev * dev = container_of(to_delayed_work(work), struct globalfifo_dev, shrink_work);
+  struct page * page, * tmp;
+  unsigned int count;
+  LIST_HEAD(victims);
+
+  mutex_lock(&dev->mutex);
+
+  if (time_before(jiffies, dev->last_use + GLOBALFIFO_IDLE)) {
+    /* still in use, look again one idle period after the last access */
+    schedule_delayed_work(&dev->shrink_work, dev->last_use + GLOBALFIFO_IDLE - jiffies);
+    goto out;
+  }
+
+  if (dev->pool_len <= GLOBALFIFO_POOL_MIN)
+    goto out;
+
+  count = DIV_ROUND_UP(dev->pool_len - GLOBALFIFO_POOL_MIN, 2);
+  while (count--) {
+    /* the back of the pool holds the pages that were used longest ago */
+    list_move(dev->pool.prev, &victims);
+    dev->pool_len--;
+    dev->stats.page_frees++;
+  }
+
+  if (dev->pool_len > GLOBALFIFO_POOL_MIN)
+    schedule_delayed_work(&dev->shrink_work, GLOBALFIFO_IDLE);
+
+out:
+  mutex_unlock(&dev->mutex);
+
+  list_for_each_entry_safe(page, tmp, &victims, lru) {
+    list_del(&page->lru);
+    __free_page(page);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_free_pages
+* Description: free every page of a chain or pool list
+* Input:       list: page list
+* Output:      None
+* Return:      None
+* Others:      only used on module exit
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_free_pages(struct list_head * list)
+{
+  struct page * page, * tmp;
+
+  list_for_each_entry_safe(page, tmp, list, lru) {
+    list_del(&page->lru);
+    __free_page(page);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_update_lowat
+* Description: recompute the smallest low watermarks of the open readers and writers
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. Readers are only woken once current_len reaches
+*              rcvlowat_min and writers once the free space reaches sndlowat_min, no
+*              sleeper can be satisfied below those levels.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_update_lowat(struct globalfifo_dev * dev)
+{
+  struct globalfifo_file * gf;
+
+  dev->rcvlowat_min = GLOBALFIFO_SIZE;
+  dev->sndlowat_min = GLOBALFIFO_SIZE;
+
+  list_for_each_entry(gf, &dev->files, list) {
+    if (gf->mode & FMODE_READ)
+      dev->rcvlowat_min = min(dev->rcvlowat_min, gf->rcvlowat);
+    if (gf->mode & FMODE_WRITE)
+      dev->sndlowat_min = min(dev->sndlowat_min, gf->sndlowat);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_read_wake
+* Description: wake function of a reader sleeping on r_wait
+* Input:       wq: wait queue entry embedded in struct globalfifo_waiter
+*              mode: task state to wake
+*              sync: sync wakeup hint
+*              key: poll mask of the event
+* Output:      None
+* Return:      0: the reader cannot make progress yet and stays asleep
+*              other: the reader was woken
+* Others:      readers sleep as exclusive waiters, so a wakeup is only counted against
+*              the one-reader limit when it goes to a reader whose rcvlowat is reached
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_read_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key)
+{
+  struct globalfifo_waiter * w = container_of(wq, struct globalfifo_waiter, wq);
+
+  if (READ_ONCE(w->gf->dev->current_len) < READ_ONCE(w->gf->rcvlowat))
+    return 0;
+
+  return default_wake_function(wq, mode, sync, key);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write_wake
+* Description: wake function of a writer sleeping on w_wait
+* Input:       wq: wait queue entry embedded in struct globalfifo_waiter
+*              mode: task state to wake
+*              sync: sync wakeup hint
+*              key: poll mask of the event
+* Output:      None
+* Return:      0: the writer cannot make progress yet and stays asleep
+*              other: the writer was woken
+* Others:      mirror of globalfifo_read_wake()
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Wait for the whole of an atomic write
+
+********************************************************************************************/
+static int globalfifo_write_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key)
+{
+  struct globalfifo_waiter * w = container_of(wq, struct globalfifo_waiter, wq);
+
+  if (GLOBALFIFO_SIZE - READ_ONCE(w->gf->dev->current_len) < globalfifo_write_need(w->gf, w->size))
+    return 0;
+
+  return default_wake_function(wq, mode, sync, key);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_notify_readers
+* Description: asynchronous notification that data arrived
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. Every open file whose rcvlowat is reached
+*              gets SIGIO if it enabled FASYNC and an eventfd count if it registered one.
+*              The signal carries POLL_IN, so with F_SETSIG send_sigio() queues the chosen
+*              real-time signal with si_fd and si_band filled in. Real-time signals queue
+*              one entry per kill, so a file is signalled once and then skipped until it
+*              reads or the fifo drops below its rcvlowat again. Writers that were told
+*              POLL_OUT are re-armed once the free space falls below their sndlowat.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Coalesce POLL_IN signals while one is pending
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Re-arm POLL_OUT against the atomic size
+
+********************************************************************************************/
+static void globalfifo_notify_readers(struct globalfifo_dev * dev)
+{
+  struct globalfifo_file * gf;
+
+  list_for_each_entry(gf, &dev->files, list) {
+    if (GLOBALFIFO_SIZE - dev->current_len < globalfifo_write_need(gf, gf->atomic))
+      gf->wr_sig_pending = false;
+
+    if (dev->current_len < gf->rcvlowat)
+      continue;
+
+    if (gf->async_queue && !gf->rd_sig_pending) {
+      gf->rd_sig_pending = true;
+      kill_fasync(&gf->async_queue, SIGIO, POLL_IN);
+      log_debug("%s kill SIGIO\n", __func__);
+    }
+
+    if (gf->rd_eventfd)
+      globalfifo_eventfd_signal(gf->rd_eventfd);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_notify_writers
+* Description: asynchronous notification that space was freed
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. Every open file whose sndlowat is free gets
+*              a POLL_OUT signal if it enabled FASYNC and an eventfd count if it registered
+*              a write eventfd. Signals are coalesced like in globalfifo_notify_readers().
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Send POLL_OUT signals when space is freed
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Wait for room for one atomic write
+
+********************************************************************************************/
+static void globalfifo_notify_writers(struct globalfifo_dev * dev)
+{
+  struct globalfifo_file * gf;
+
+  list_for_each_entry(gf, &dev->files, list) {
+    if (dev->current_len < gf->rcvlowat)
+      gf->rd_sig_pending = false;
+
+    if (GLOBALFIFO_SIZE - dev->current_len < globalfifo_write_need(gf, gf->atomic))
+      continue;
+
+    /* only files open for writing care about free space */
+    if (gf->async_queue && (gf->mode & FMODE_WRITE) && !gf->wr_sig_pending) {
+      gf->wr_sig_pending = true;
+      kill_fasync(&gf->async_queue, SIGIO, POLL_OUT);
+      log_debug("%s kill SIGIO\n", __func__);
+    }
+
+    if (gf->wr_eventfd)
+      globalfifo_eventfd_signal(gf->wr_eventfd);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_set_eventfd
+* Description: register or drop the eventfd of an open file
+* Input:       gf: per file state
+*              cmd: FIFO_SET_RD_EVENTFD_CMD or FIFO_SET_WR_EVENTFD_CMD
+*              fd: eventfd descriptor, negative to drop the registration
+* Output:      None
+* Return:      0: execute success
+*              other: fd is not an eventfd
+* Others:      the eventfd is signalled right away when the condition already holds,
+*              so an edge-triggered event loop does not miss data queued before
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Wait for room for one atomic write
+
+********************************************************************************************/
+static int globalfifo_set_eventfd(struct globalfifo_file * gf, unsigned int cmd, int fd)
+{
+  struct eventfd_ctx * ctx = NULL;
+  struct eventfd_ctx * old;
+  struct globalfifo_dev * dev = gf->dev;
+
+  if (fd >= 0) {
+    ctx = eventfd_ctx_fdget(fd);
+    if (IS_ERR(ctx))
+      return PTR_ERR(ctx);
+  }
+
+  mutex_lock(&dev->mutex);
+  if (cmd == FIFO_SET_RD_EVENTFD_CMD) {
+    old = gf->rd_eventfd;
+    gf->rd_eventfd = ctx;
+    if (ctx && dev->current_len >= gf->rcvlowat)
+      globalfifo_eventfd_signal(ctx);
+  } else {
+    old = gf->wr_eventfd;
+    gf->wr_eventfd = ctx;
+    if (ctx && GLOBALFIFO_SIZE - dev->current_len >= globalfifo_write_need(gf, gf->atomic))
+      globalfifo_eventfd_signal(ctx);
+  }
+  mutex_unlock(&dev->mutex);
+
+  if (old)
+    eventfd_ctx_put(old);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_stats_show
+* Description: print the blocking and occupancy counters
+* Input:       s: seq file of /sys/kernel/debug/globalfifo/stats
+*              unused: seq iterator, not used
+* Output:      None
+* Return:      0: execute success
+* Others:      the counters are copied under dev->mutex so one snapshot is consistent
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Show the chain and pool sizes and page allocator calls
+
+********************************************************************************************/
+static int globalfifo_stats_show(struct seq_file * s, void * unused)
+{
+  struct globalfifo_dev * dev = s->private;
+  struct globalfifo_stats st;
+  unsigned int len, nr_pages, pool_len;
+
+  mutex_lock(&dev->mutex);
+  st = dev->stats;
+  len = dev->current_len;
+  nr_pages = dev->nr_pages;
+  pool_len = dev->pool_len;
+  mutex_unlock(&dev->mutex);
+
+  seq_printf(s, "size:        %u\n", GLOBALFIFO_SIZE);
+  seq_printf(s, "current_len: %u\n", len);
+  seq_printf(s, "max_len:     %u\n", st.max_len);
+  seq_printf(s, "rd_bytes:    %llu\n", st.rd_bytes);
+  seq_printf(s, "rd_sleeps:   %llu\n", st.rd_sleeps);
+  seq_printf(s, "rd_sleep_ns: %llu\n", st.rd_sleep_ns);
+  seq_printf(s, "rd_eagain:   %llu\n", st.rd_eagain);
+  seq_printf(s, "wr_bytes:    %llu\n", st.wr_bytes);
+  seq_printf(s, "wr_sleeps:   %llu\n", st.wr_sleeps);
+  seq_printf(s, "wr_sleep_ns: %llu\n", st.wr_sleep_ns);
+  seq_printf(s, "wr_eagain:   %llu\n", st.wr_eagain);
+  seq_printf(s, "pages:       %u\n", nr_pages);
+  seq_printf(s, "pool:        %u\n", pool_len);
+  seq_printf(s, "page_allocs: %llu\n", st.page_allocs);
+  seq_printf(s, "page_frees:  %llu\n", st.page_frees);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_stats_reset
+* Description: clear the counters, any value written to debugfs reset does it
+* Input:       data: globalfifo device
+*              val: written value, ignored
+* Output:      None
+* Return:      0: execute success
+* Others:      max_len restarts from the current occupancy
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_stats_reset(void * data, u64 val)
+{
+  struct globalfifo_dev * dev = data;
+
+  mutex_lock(&dev->mutex);
+  memset(&dev->stats, 0, sizeof(dev->stats));
+  dev->stats.max_len = dev->current_len;
+  mutex_unlock(&dev->mutex);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write_need
+* Description: free space a write of this file has to wait for
+* Input:       gf: per file state
+*              size: write data size
+* Output:      None
+* Return:      unsigned int: free bytes needed
+* Others:      lockless. A write of at most gf->atomic bytes waits until it fits entirely,
+*              any other write only until sndlowat bytes are free.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static unsigned int globalfifo_write_need(struct globalfifo_file * gf, size_t size)
+{
+  unsigned int need = READ_ONCE(gf->sndlowat);
+
+  if (size <= READ_ONCE(gf->atomic))
+    need = max_t(unsigned int, need, size);
+
+  return need;
+}
+
+
+/*
+  ** module declaration
+*/
+module_init(globalfifo_init);
+module_exit(globalfifo_exit);
+
+MODULE_AUTHOR("JexJiang");
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("A simple Hello World Module");
+MODULE_ALIAS("a simplest module");
+MODULE_VERSION("v1.0");
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
@@ -0,0 +1,162 @@
+/*
+  ** @file           : app_globalfifo_percpu.c
+  ** @brief          : global fifo per cpu producer queues application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   RECORD_SIZE                 (64)
+#define   RUN_SECONDS                 (5)
+#define   MAX_WRITERS                 (256)
+
+
+/*
+  ** static global variable
+*/
+static volatile int stop;
+static long long written[MAX_WRITERS];
+
+
+/********************************************************************************************
+* Function:    writer
+* Description: write RECORD_SIZE byte records from one cpu until stop is set
+* Input:       arg: writer index, also the cpu it is pinned to
+* Output:      None
+* Return:      NULL
+* Others:
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void * writer(void * arg)
+{
+  long id = (long)arg;
+  int fd;
+  char buf[RECORD_SIZE];
+  cpu_set_t set;
+
+  CPU_ZERO(&set);
+  CPU_SET(id, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+  /* non-blocking so no writer is left asleep once the reader stops */
+  fd = open("/dev/globalfifo", O_WRONLY | O_NONBLOCK);
+  if (-1 == fd)
+    return NULL;
+
+  memset(buf, 'a' + id % 26, sizeof(buf));
+  while (!stop) {
+    if (write(fd, buf, sizeof(buf)) > 0)
+      written[id] += sizeof(buf);
+  }
+
+  close(fd);
+  return NULL;
+}
+
+
+/********************************************************************************************
+* Function:    reader
+* Description: drain the fifo until stop is set
+* Input:       arg: not used
+* Output:      None
+* Return:      NULL
+* Others:      non-blocking so it notices stop without a final write
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void * reader(void * arg)
+{
+  int fd;
+  static char buf[65536];
+
+  fd = open("/dev/globalfifo", O_RDONLY | O_NONBLOCK);
+  if (-1 == fd)
+    return NULL;
+
+  while (!stop)
+    read(fd, buf, sizeof(buf));
+
+  close(fd);
+  return NULL;
+}
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list, argv[1] is the number of writers, one per cpu
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      compare the result with globalfifo_percpu=0 to see the scaling
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+int main(int argc, char * argv[])
+{
+    long i, n = argc > 1 ? atol(argv[1]) : 2;
+    long long total = 0;
+    pthread_t rd, wr[MAX_WRITERS];
+
+    if (n < 1 || n > MAX_WRITERS)
+        n = 2;
+
+    pthread_create(&rd, NULL, reader, NULL);
+    for (i = 0; i < n; i++)
+        pthread_create(&wr[i], NULL, writer, (void *)i);
+
+    sleep(RUN_SECONDS);
+    stop = 1;
+
+    for (i = 0; i < n; i++) {
+        pthread_join(wr[i], NULL);
+        total += written[i];
+    }
+    pthread_join(rd, NULL);
+
+    log_debug("%ld writers: %lld MiB/s\n", n, total / RUN_SECONDS >> 20);
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
@@ -0,0 +1,894 @@
+/*
+  ** @file           : drv_globalfifo_percpu.c
+  ** @brief          : global fifo per cpu producer queues driver source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/cdev.h>
+#include <linux/kern_levels.h>
+#include <linux/printk.h>
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/sched/signal.h>
+#include <linux/memory.h>
+#include <linux/poll.h>
+#include <linux/percpu.h>
+#include <linux/topology.h>
+#include <linux/timekeeping.h>
+
+
+/*
+  ** define
+*/
+#define     GLOBALFIFO_CPU_SIZE     (0x1000)
+#define     GLOBALFIFO_CPU_MASK     (GLOBALFIFO_CPU_SIZE - 1)
+#define     GLOBALFIFO_REC_HDR      (sizeof(struct globalfifo_rec))
+#define     GLOBALFIFO_REC_MAX      (GLOBALFIFO_CPU_SIZE - GLOBALFIFO_REC_HDR)
+#define     MEM_CLEAR_CMD           (0x1)
+#define     GLOBALFIFO_MAJOR        (230)
+
+#define     log_debug(fmt, ...)     printk(KERN_DEBUG   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_info(fmt, ...)      printk(KERN_INFO    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_notice(fmt, ...)    printk(KERN_NOTICE  pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_warning(fmt, ...)   printk(KERN_WARNING pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_err(fmt, ...)       printk(KERN_ERR     pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_crit(fmt, ...)      printk(KERN_CRIT    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_alert(fmt, ...)     printk(KERN_ALERT   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_emerg(fmt, ...)     printk(KERN_EMERG   pr_fmt(fmt), ##__VA_ARGS__)
+
+/* records start on a header boundary, so a header never wraps around the end of mem */
+#define     globalfifo_rec_size(len)        ALIGN(GLOBALFIFO_REC_HDR + (len), GLOBALFIFO_REC_HDR)
+#define     globalfifo_rec_at(c, pos)       ((struct globalfifo_rec *)((c)->mem + ((pos) & GLOBALFIFO_CPU_MASK)))
+
+
+/*
+  ** struct
+*/
+
+/*
+  ** every write becomes one record in the sub-ring of the writing cpu, ns is the commit
+  ** time the reader merges on
+*/
+struct globalfifo_rec {
+  u32 len;
+  u32 reserved;
+  u64 ns;
+};
+
+/*
+  ** sub-ring of one cpu. head and tail are free running byte counts, tail is published
+  ** with smp_store_release() so the reader can scan every sub-ring without its mutex.
+  ** The mutex is taken by the writers of this cpu and briefly by the reader, writers on
+  ** different cpus never share a lock or a cache line. hoff is the part of the head
+  ** record a previous read has already returned.
+*/
+struct globalfifo_cpu {
+  struct mutex mutex;
+  unsigned int head;
+  unsigned int tail;
+  unsigned int hoff;
+  wait_queue_head_t w_wait;
+  unsigned char * mem;
+};
+
+/*
+  ** mutex serializes the readers and protects cur and next: cur is the cpu whose head
+  ** record was partly read, -1 when there is none, next is where the round robin
+  ** scan resumes when globalfifo_order is off
+*/
+struct globalfifo_dev {
+  struct cdev cdev;
+  struct globalfifo_cpu __percpu * cpus;
+  struct mutex mutex;
+  int cur;
+  int next;
+  wait_queue_head_t r_wait;
+  struct fasync_struct * async_queue;
+};
+
+
+/*
+  ** static function declaration
+*/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos);
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos);
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig);
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg);
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait);
+static int globalfifo_open(struct inode * inode, struct file * filp);
+static int globalfifo_release(struct inode * inode, struct file *filp);
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index);
+static int globalfifo_fasync(int fd, struct file * filp, int mode);
+static struct globalfifo_cpu * globalfifo_this_cpu(struct globalfifo_dev * dev);
+static unsigned int globalfifo_cpu_room(struct globalfifo_cpu * c);
+static bool globalfifo_readable(struct globalfifo_dev * dev);
+static int globalfifo_cpu_put(struct globalfifo_cpu * c, const char __user * buf, size_t size);
+static int globalfifo_cpu_get(struct globalfifo_cpu * c, char __user * buf, size_t size, u64 limit);
+static int globalfifo_pick(struct globalfifo_dev * dev, u64 * limit);
+static void globalfifo_free_cpus(struct globalfifo_dev * dev);
+
+
+/*
+  ** global variable
+*/
+static const struct file_operations globalfifo_fops = {
+  .owner = THIS_MODULE,
+  .llseek = globalfifo_llseek,
+  .read = globalfifo_read,
+  .write = globalfifo_write,
+  .unlocked_ioctl = globalfifo_ioctl,
+  .poll = globalfifo_poll,
+  .fasync = globalfifo_fasync,
+  .open = globalfifo_open,
+  .release = globalfifo_release,
+};
+
+
+/*
+  ** static global variable
+*/
+static int globalfifo_major = GLOBALFIFO_MAJOR;
+module_param(globalfifo_major, int, S_IRUGO);
+
+/* one sub-ring per cpu, off puts every writer on the sub-ring of cpu 0 */
+static bool globalfifo_percpu = true;
+module_param(globalfifo_percpu, bool, S_IRUGO);
+
+/* merge the sub-rings by commit time, off drains them round robin */
+static bool globalfifo_order = true;
+module_param(globalfifo_order, bool, S_IRUGO);
+
+struct globalfifo_dev * globalfifo_devp;
+
+
+/*
+  ** static function list
+*/
+
+/********************************************************************************************
+* Function:    globalfifo_read
+* Description: globalfifo read data
+* Input:       filp: struct file
+*              size: read data size
+*              ppos: pos offset
+* Output:      buf: read buffer
+* Return:      ssize_t: read data count
+* Others:      merges the records of all sub-rings, see globalfifo_pick()
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos)
+{
+  int ret = 0, cpu;
+  size_t done = 0;
+  u64 limit;
+  struct globalfifo_cpu * c;
+  struct globalfifo_dev * dev = filp->private_data;
+
+  mutex_lock(&dev->mutex);
+
+  while (!globalfifo_readable(dev)) {
+    mutex_unlock(&dev->mutex);
+
+    if (filp->f_flags & O_NONBLOCK)
+      return -EAGAIN;
+
+    ret = wait_event_interruptible(dev->r_wait, globalfifo_readable(dev));
+    if (ret)
+      return ret;
+
+    mutex_lock(&dev->mutex);
+  }
+
+  while (done < size) {
+    cpu = globalfifo_pick(dev, &limit);
+    if (cpu < 0)
+      break;
+
+    c = per_cpu_ptr(dev->cpus, cpu);
+    mutex_lock(&c->mutex);
+    ret = globalfifo_cpu_get(c, buf + done, size - done, limit);
+    dev->cur = c->hoff ? cpu : -1;
+    mutex_unlock(&c->mutex);
+
+    /* wq_has_sleeper() orders the head update before the check */
+    if (ret > 0 && wq_has_sleeper(&c->w_wait))
+      wake_up_interruptible(&c->w_wait);
+
+    if (ret <= 0)
+      break;
+
+    done += ret;
+  }
+
+  mutex_unlock(&dev->mutex);
+
+  /* a fault after some bytes were copied returns the short count */
+  if (!done)
+    return ret;
+
+  log_debug("read %zu bytes(s)\n", done);
+  return done;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write
+* Description: globalfifo write data
+* Input:       filp: struct file
+*              buf: write buffer
+*              size: write data size
+*              ppos: pos offset
+* Output:      None
+* Return:      ssize_t: write data count
+* Others:      appends one record to the sub-ring of the current cpu, only its mutex is
+*              taken. A write larger than the free space is cut, like on the other
+*              globalfifo drivers.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos)
+{
+  int ret;
+  struct globalfifo_cpu * c;
+  struct globalfifo_dev * dev = filp->private_data;
+
+  if (!size)
+    return 0;
+
+  size = min_t(size_t, size, GLOBALFIFO_REC_MAX);
+
+  while (1) {
+    /* the task may have moved since it last slept, pick the sub-ring again */
+    c = globalfifo_this_cpu(dev);
+
+    mutex_lock(&c->mutex);
+    ret = globalfifo_cpu_put(c, buf, size);
+    mutex_unlock(&c->mutex);
+
+    if (ret)
+      break;
+
+    if (filp->f_flags & O_NONBLOCK)
+      return -EAGAIN;
+
+    ret = wait_event_interruptible(c->w_wait, globalfifo_cpu_room(c) > GLOBALFIFO_REC_HDR);
+    if (ret)
+      return ret;
+  }
+
+  if (ret < 0)
+    return ret;
+
+  /* readers only sleep when every sub-ring is empty, do not touch r_wait otherwise */
+  if (wq_has_sleeper(&dev->r_wait))
+    wake_up_interruptible(&dev->r_wait);
+
+  kill_fasync(&dev->async_queue, SIGIO, POLL_IN);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_llseek
+* Description: globalfifo llseek pos
+* Input:       filp: struct file
+*              offset: pos offse
+*              orig: pos flag
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig)
+{
+  loff_t ret = 0;
+  switch (orig) {
+  case 0:
+    if (offset < 0) {
+      ret = -EINVAL;
+      break;
+    }
+
+    if((unsigned int)offset > GLOBALFIFO_CPU_SIZE) {
+      ret = -EINVAL;
+      break;
+    }
+
+    filp->f_pos = (unsigned int)offset;
+    ret = filp->f_pos;
+    break;
+  case 1:
+    if ((filp->f_pos + offset) > GLOBALFIFO_CPU_SIZE) {
+      ret = -EINVAL;
+      break;
+    }
+
+    if ((filp->f_pos + offset) < 0) {
+      ret = -EINVAL;
+      break;
+    }
+    filp->f_pos += offset;
+    ret = filp->f_pos;
+    break;
+
+  default:
+    ret = -EINVAL;
+    break;
+
+  }
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ioctl
+* Description: globalfifo ioctl
+* Input:       filp: struct file
+*              cmd: command
+*              arg: argue
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      MEM_CLEAR_CMD empties every sub-ring, zeroing the memory in place would
+*              destroy the record headers
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg)
+{
+  int cpu;
+  struct globalfifo_cpu * c;
+  struct globalfifo_dev * dev = filp->private_data;
+
+  switch (cmd)
+  {
+  case MEM_CLEAR_CMD:
+    mutex_lock(&dev->mutex);
+    for_each_possible_cpu(cpu) {
+      c = per_cpu_ptr(dev->cpus, cpu);
+
+      mutex_lock(&c->mutex);
+      WRITE_ONCE(c->head, c->tail);
+      c->hoff = 0;
+      memset(c->mem, 0, GLOBALFIFO_CPU_SIZE);
+      mutex_unlock(&c->mutex);
+
+      wake_up_interruptible(&c->w_wait);
+    }
+    dev->cur = -1;
+    mutex_unlock(&dev->mutex);
+
+    log_debug("globalfifo is set to zero\n");
+    break;
+
+  default:
+    return -EINVAL;
+    break;
+  }
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_poll
+* Description: globalfifo poll
+* Input:       filp: struct file
+*              poll_table: poll table pointer
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      POLLOUT reports the sub-ring a write from the current cpu would use
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait)
+{
+  unsigned int mask = 0;
+  struct globalfifo_dev * dev = filp->private_data;
+  struct globalfifo_cpu * c = globalfifo_this_cpu(dev);
+
+  poll_wait(filp, &dev->r_wait, wait);
+  poll_wait(filp, &c->w_wait, wait);
+
+  if (globalfifo_readable(dev)) {
+    mask |= POLLIN | POLLRDNORM;
+  }
+
+  if (globalfifo_cpu_room(c) > GLOBALFIFO_REC_HDR) {
+    mask |= POLLOUT | POLLWRNORM;
+  }
+
+  return mask;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_fasync
+* Description: globalfifo fasync
+* Input:       fd: file descriptor
+*              filp: struct file
+*              mode: file mode
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_fasync(int fd, struct file * filp, int mode)
+{
+  struct globalfifo_dev * dev = filp->private_data;
+
+  return fasync_helper(fd, filp, mode, &dev->async_queue);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_open
+* Description: globalfifo open
+* Input:       inode: inode
+* Output:      filp: strcut file
+* Return:      0: execute success
+*              other: execute failure
+* Others:
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_open(struct inode * inode, struct file * filp)
+{
+  filp->private_data = globalfifo_devp;
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_release
+* Description: globalfifo relesase
+* Input:       inode: inode
+*              filp: strcut file
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_release(struct inode * inode, struct file *filp)
+{
+  globalfifo_fasync(-1, filp, 0);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_init
+* Description: globalfifo initial
+* Input:       Noen
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      each sub-ring is allocated on the memory node of its cpu
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int __init globalfifo_init(void)
+{
+    int ret, cpu;
+    struct globalfifo_cpu * c;
+
+    dev_t devno = MKDEV(globalfifo_major, 0);
+
+    if (globalfifo_major)
+      ret = register_chrdev_region(devno, 1, "globalfifo");
+    else {
+      ret = alloc_chrdev_region(&devno, 0, 1, "globalfifo");
+      globalfifo_major = MAJOR(devno);
+    }
+
+    if (ret < 0)
+      return ret;
+
+    globalfifo_devp = kzalloc(sizeof(struct globalfifo_dev), GFP_KERNEL);
+    if (!globalfifo_devp) {
+      ret = -ENOMEM;
+      goto fail_malloc;
+    }
+
+    globalfifo_devp->cpus = alloc_percpu(struct globalfifo_cpu);
+    if (!globalfifo_devp->cpus) {
+      ret = -ENOMEM;
+      goto fail_percpu;
+    }
+
+    for_each_possible_cpu(cpu) {
+      c = per_cpu_ptr(globalfifo_devp->cpus, cpu);
+      mutex_init(&c->mutex);
+      init_waitqueue_head(&c->w_wait);
+      c->mem = kzalloc_node(GLOBALFIFO_CPU_SIZE, GFP_KERNEL, cpu_to_node(cpu));
+      if (!c->mem) {
+        ret = -ENOMEM;
+        goto fail_mem;
+      }
+    }
+
+    mutex_init(&globalfifo_devp->mutex);
+    init_waitqueue_head(&globalfifo_devp->r_wait);
+    globalfifo_devp->cur = -1;
+    globalfifo_setup_cdev(globalfifo_devp, 0);
+
+    return 0;
+
+fail_mem:
+    globalfifo_free_cpus(globalfifo_devp);
+fail_percpu:
+    kfree(globalfifo_devp);
+fail_malloc:
+    unregister_chrdev_region(devno, 1);
+    return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_exit
+* Description: globalfifo exit
+* Input:       Noen
+* Output:      None
+* Return:      None
+* Others:
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void __exit globalfifo_exit(void)
+{
+    cdev_del(&globalfifo_devp->cdev);
+    globalfifo_free_cpus(globalfifo_devp);
+    kfree(globalfifo_devp);
+    unregister_chrdev_region(MKDEV(globalfifo_major, 0), 1);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_setup_cdev
+* Description: globalfifo setup cdev struct
+* Input:       index: cdev index node
+* Output:      dev: initialed cdev
+* Return:      None
+* Others:
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index)
+{
+  int err, devno = MKDEV(globalfifo_major, index);
+
+  cdev_init(&dev->cdev, &globalfifo_fops);
+  dev->cdev.owner = THIS_MODULE;
+
+  err = cdev_add(&dev->cdev, devno, 1);
+  if (err)
+    log_debug("Error %d adding globalfifo%d", err, index);
+
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_this_cpu
+* Description: sub-ring a write from the current cpu goes to
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      struct globalfifo_cpu *: the sub-ring
+* Others:      the task may migrate right after, that only costs locality because the
+*              sub-ring has its own mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static struct globalfifo_cpu * globalfifo_this_cpu(struct globalfifo_dev * dev)
+{
+  return per_cpu_ptr(dev->cpus, globalfifo_percpu ? raw_smp_processor_id() : 0);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_cpu_room
+* Description: free bytes of a sub-ring
+* Input:       c: sub-ring
+* Output:      None
+* Return:      unsigned int: free bytes, always a multiple of GLOBALFIFO_REC_HDR
+* Others:      lockless
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static unsigned int globalfifo_cpu_room(struct globalfifo_cpu * c)
+{
+  return GLOBALFIFO_CPU_SIZE - (READ_ONCE(c->tail) - READ_ONCE(c->head));
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_readable
+* Description: check whether any sub-ring holds a record
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      true: there is data to read
+*              false: every sub-ring is empty
+* Others:      lockless, only reads the head and tail of each cpu
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static bool globalfifo_readable(struct globalfifo_dev * dev)
+{
+  int cpu;
+  struct globalfifo_cpu * c;
+
+  for_each_possible_cpu(cpu) {
+    c = per_cpu_ptr(dev->cpus, cpu);
+    if (smp_load_acquire(&c->tail) != READ_ONCE(c->head))
+      return true;
+  }
+
+  return false;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_cpu_put
+* Description: copy a write from user space into a new record of a sub-ring
+* Input:       c: sub-ring
+*              buf: write buffer
+*              size: write data size, at most GLOBALFIFO_REC_MAX
+* Output:      None
+* Return:      int: bytes written, cut to the free space
+*              0: the sub-ring is full
+*              -EFAULT: copy from user failure, the sub-ring is left untouched
+* Others:      caller must hold c->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_cpu_put(struct globalfifo_cpu * c, const char __user * buf, size_t size)
+{
+  struct globalfifo_rec * rec;
+  unsigned int room = globalfifo_cpu_room(c);
+  unsigned int len, off, first;
+
+  if (room <= GLOBALFIFO_REC_HDR)
+    return 0;
+
+  len = min_t(size_t, size, room - GLOBALFIFO_REC_HDR);
+  off = (c->tail + GLOBALFIFO_REC_HDR) & GLOBALFIFO_CPU_MASK;
+  first = min_t(unsigned int, len, GLOBALFIFO_CPU_SIZE - off);
+
+  if (copy_from_user(c->mem + off, buf, first))
+    return -EFAULT;
+
+  if (copy_from_user(c->mem, buf + first, len - first))
+    return -EFAULT;
+
+  rec = globalfifo_rec_at(c, c->tail);
+  rec->len = len;
+  rec->ns = globalfifo_order ? ktime_get_ns() : 0;
+
+  /* the reader scans without c->mutex, the record must be complete before it is seen */
+  smp_store_release(&c->tail, c->tail + globalfifo_rec_size(len));
+
+  return len;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_cpu_get
+* Description: copy records of a sub-ring to user space
+* Input:       c: sub-ring
+*              size: read data size
+*              limit: stop before a record committed after this time, the first record
+*                     is always taken
+* Output:      buf: read buffer
+* Return:      int: bytes read
+*              -EFAULT: nothing could be copied
+* Others:      caller must hold c->mutex. A record that does not fit in buf is
+*              returned in pieces, c->hoff remembers how much of it is gone.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_cpu_get(struct globalfifo_cpu * c, char __user * buf, size_t size, u64 limit)
+{
+  struct globalfifo_rec * rec;
+  unsigned int len, off, first;
+  size_t done = 0;
+
+  while (done < size && c->head != c->tail) {
+    rec = globalfifo_rec_at(c, c->head);
+    if (done && rec->ns > limit)
+      break;
+
+    off = (c->head + GLOBALFIFO_REC_HDR + c->hoff) & GLOBALFIFO_CPU_MASK;
+    len = min_t(size_t, rec->len - c->hoff, size - done);
+    first = min_t(unsigned int, len, GLOBALFIFO_CPU_SIZE - off);
+
+    if (copy_to_user(buf + done, c->mem + off, first) ||
+        copy_to_user(buf + done + first, c->mem, len - first))
+      return done ? done : -EFAULT;
+
+    done += len;
+    c->hoff += len;
+    if (c->hoff == rec->len) {
+      c->hoff = 0;
+      WRITE_ONCE(c->head, c->head + globalfifo_rec_size(rec->len));
+    }
+  }
+
+  return done;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_pick
+* Description: choose the sub-ring the next bytes of a read come from
+* Input:       dev: globalfifo device
+* Output:      limit: commit time up to which the chosen sub-ring may be drained
+* Return:      int: cpu of the sub-ring
+*              -1: every sub-ring is empty
+* Others:      caller must hold dev->mutex. A partly read record is always finished
+*              first. With globalfifo_order the sub-ring with the oldest head record
+*              wins and is drained until its records get newer than the runner-up,
+*              records committed at the same moment on two cpus may come in either
+*              order. Without it the sub-rings are drained one after the other.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_pick(struct globalfifo_dev * dev, u64 * limit)
+{
+  int i, cpu, best = -1;
+  u64 ns, first = U64_MAX, second = U64_MAX;
+  struct globalfifo_cpu * c;
+
+  *limit = U64_MAX;
+
+  if (!globalfifo_order) {
+    if (dev->cur >= 0)
+      return dev->cur;
+
+    for (i = 0; i < nr_cpu_ids; i++) {
+      cpu = (dev->next + i) % nr_cpu_ids;
+      if (!cpu_possible(cpu))
+        continue;
+
+      c = per_cpu_ptr(dev->cpus, cpu);
+      if (smp_load_acquire(&c->tail) != c->head) {
+        dev->next = cpu + 1;
+        return cpu;
+      }
+    }
+
+    return -1;
+  }
+
+  for_each_possible_cpu(cpu) {
+    c = per_cpu_ptr(dev->cpus, cpu);
+    if (smp_load_acquire(&c->tail) == c->head)
+      continue;
+
+    ns = (cpu == dev->cur) ? 0 : globalfifo_rec_at(c, c->head)->ns;
+    if (ns < first) {
+      second = first;
+      first = ns;
+      best = cpu;
+    } else if (ns < second) {
+      second = ns;
+    }
+  }
+
+  *limit = second;
+
+  return best;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_free_cpus
+* Description: free the sub-rings
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      also undoes a partly finished globalfifo_init()
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_free_cpus(struct globalfifo_dev * dev)
+{
+  int cpu;
+
+  for_each_possible_cpu(cpu)
+    kfree(per_cpu_ptr(dev->cpus, cpu)->mem);
+
+  free_percpu(dev->cpus);
+}
+
+
+/*
+  ** module declaration
+*/
+module_init(globalfifo_init);
+module_exit(globalfifo_exit);
+
+MODULE_AUTHOR("JexJiang");
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("A simple Hello World Module");
+MODULE_ALIAS("a simplest module");
+MODULE_VERSION("v1.0");
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
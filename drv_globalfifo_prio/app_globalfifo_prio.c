@@ -0,0 +1,139 @@
+/*
+  ** @file           : app_globalfifo_prio.c
+  ** @brief          : global fifo priority lanes application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   FIFO_SET_LANE_CMD           (0x6)
+#define   FIFO_PEEK_LANE_CMD          (0x7)
+#define   URGENT_LANE                 (2)
+#define   BUFFER_SIZE                 (64)
+
+
+/********************************************************************************************
+* Function:    prio_writer
+* Description: keep the bulk lane busy and send a control message every second
+* Input:       None
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      one descriptor per lane, the lane is a property of the open file
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int prio_writer(void)
+{
+    int bulk, ctrl, num = 0;
+    char buf[BUFFER_SIZE];
+
+    bulk = open("/dev/globalfifo", O_WRONLY | O_NONBLOCK);
+    ctrl = open("/dev/globalfifo", O_WRONLY);
+    if (-1 == bulk || -1 == ctrl) {
+        log_debug("/dev/globalfifo open failure\r\n");
+        return -1;
+    }
+
+    ioctl(ctrl, FIFO_SET_LANE_CMD, URGENT_LANE);
+    memset(buf, 'b', sizeof(buf));
+
+    while (1) {
+        /* fills the bulk lane, the urgent lane keeps its own space */
+        while (write(bulk, buf, sizeof(buf)) > 0)
+            ;
+
+        snprintf(buf, sizeof(buf), "ctrl %d", num++);
+        write(ctrl, buf, strlen(buf));
+        memset(buf, 'b', sizeof(buf));
+        sleep(1);
+    }
+
+    return 0;
+}
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list, "w" runs the writer, anything else the reader
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      the reader sleeps in poll() and serves POLLPRI before the bulk backlog
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+int main(int argc, char * argv[])
+{
+    int fd, lane;
+    ssize_t len;
+    char buf[BUFFER_SIZE + 1];
+    struct pollfd pfd;
+
+    if (argc > 1 && 'w' == argv[1][0])
+        return prio_writer();
+
+    fd = open("/dev/globalfifo", O_RDONLY | O_NONBLOCK);
+    if (-1 == fd) {
+        log_debug("/dev/globalfifo open failure\r\n");
+        return -1;
+    }
+
+    pfd.fd = fd;
+    pfd.events = POLLIN | POLLPRI;
+
+    while (1) {
+        poll(&pfd, 1, -1);
+
+        if (ioctl(fd, FIFO_PEEK_LANE_CMD, &lane) < 0)
+            continue;
+
+        len = read(fd, buf, BUFFER_SIZE);
+        if (len <= 0)
+            continue;
+
+        buf[len] = '\0';
+        if (URGENT_LANE == lane)
+            log_debug("urgent: %s\n", buf);
+        else
+            usleep(10000);  /* a slow bulk consumer */
+    }
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
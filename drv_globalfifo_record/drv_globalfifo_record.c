@@ -0,0 +1,887 @@
+/*
+  ** @file           : drv_globalfifo_record.c
+  ** @brief          : global fifo record (message-boundary) driver source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/cdev.h>
+#include <linux/kern_levels.h>
+#include <linux/printk.h>
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/sched/signal.h>
+#include <linux/memory.h>
+#include <linux/poll.h>
+
+
+/*
+  ** define
+*/
+#define     GLOBALFIFO_SIZE         (0x1000)
+#define     GLOBALFIFO_MASK         (GLOBALFIFO_SIZE - 1)
+#define     MEM_CLEAR_CMD           (0x1)
+#define     FIFO_SET_BATCH_CMD      (0x2)
+#define     GLOBALFIFO_HDR_SIZE     (sizeof(u32))
+#define     GLOBALFIFO_MAX_RECORD   (GLOBALFIFO_SIZE - GLOBALFIFO_HDR_SIZE)
+#define     GLOBALFIFO_MAJOR        (230)
+
+#define     log_debug(fmt, ...)     printk(KERN_DEBUG   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_info(fmt, ...)      printk(KERN_INFO    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_notice(fmt, ...)    printk(KERN_NOTICE  pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_warning(fmt, ...)   printk(KERN_WARNING pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_err(fmt, ...)       printk(KERN_ERR     pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_crit(fmt, ...)      printk(KERN_CRIT    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_alert(fmt, ...)     printk(KERN_ALERT   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_emerg(fmt, ...)     printk(KERN_EMERG   pr_fmt(fmt), ##__VA_ARGS__)
+
+
+/*
+  ** struct
+*/
+struct globalfifo_dev {
+  struct cdev cdev;
+  unsigned int current_len;
+  unsigned int head;
+  unsigned int tail;
+  unsigned char mem[GLOBALFIFO_SIZE];
+  struct mutex mutex;
+  wait_queue_head_t r_wait;
+  wait_queue_head_t w_wait;
+  struct fasync_struct * async_queue;
+};
+
+/*
+  ** per open file state, batch makes read() return as many whole records as fit,
+  ** each one still preceded by its u32 length
+*/
+struct globalfifo_file {
+  struct globalfifo_dev * dev;
+  bool batch;
+};
+
+
+/*
+  ** static function declaration
+*/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos);
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos);
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig);
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg);
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait);
+static int globalfifo_open(struct inode * inode, struct file * filp);
+static int globalfifo_release(struct inode * inode, struct file *filp);
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index);
+static int globalfifo_ring_get(struct globalfifo_dev * dev, char __user * buf, unsigned int size);
+static int globalfifo_ring_put(struct globalfifo_dev * dev, const char __user * buf, unsigned int size);
+static void globalfifo_ring_peek(struct globalfifo_dev * dev, void * dst, unsigned int size);
+static void globalfifo_ring_put_kernel(struct globalfifo_dev * dev, const void * src, unsigned int size);
+static ssize_t globalfifo_record_get(struct globalfifo_file * gf, char __user * buf, size_t size);
+static ssize_t globalfifo_record_put(struct globalfifo_dev * dev, const char __user * buf, size_t size);
+static unsigned int globalfifo_write_room(size_t size);
+static int globalfifo_fasync(int fd, struct file * filp, int mode);
+
+
+/*
+  ** global variable
+*/
+static const struct file_operations globalfifo_fops = {
+  .owner = THIS_MODULE,
+  .llseek = globalfifo_llseek,
+  .read = globalfifo_read,
+  .write = globalfifo_write,
+  .unlocked_ioctl = globalfifo_ioctl,
+  .poll = globalfifo_poll,
+  .fasync = globalfifo_fasync,
+  .open = globalfifo_open,
+  .release = globalfifo_release,
+};
+
+
+/*
+  ** static global variable
+*/
+static int globalfifo_major = GLOBALFIFO_MAJOR;
+module_param(globalfifo_major, int, S_IRUGO);
+
+static bool globalfifo_record = true;
+module_param(globalfifo_record, bool, S_IRUGO);
+
+struct globalfifo_dev * globalfifo_devp;
+
+
+/* 
+  ** static function list
+*/
+
+/********************************************************************************************
+* Function:    globalfifo_read
+* Description: globalfifo read data
+* Input:       filp: struct file
+*              size: read data size
+*              ppos: pos offset
+* Output:      buf: read buffer
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Read from the ring head instead of shifting the buffer
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Return whole records in record mode
+
+********************************************************************************************/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos)
+{
+  ssize_t ret = 0;
+  struct globalfifo_file *gf = filp->private_data;
+  struct globalfifo_dev *dev = gf->dev;
+
+  DECLARE_WAITQUEUE(wait, current);
+
+  mutex_lock(&dev->mutex);
+  add_wait_queue(&dev->r_wait, &wait);
+
+  while(dev->current_len == 0) {
+    if (filp->f_flags & O_NONBLOCK) {
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    __set_current_state(TASK_INTERRUPTIBLE);
+    mutex_unlock(&dev->mutex);
+
+    schedule();
+    if(signal_pending(current)) {
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+  }
+
+  if (globalfifo_record) {
+    ret = globalfifo_record_get(gf, buf, size);
+    if (ret > 0)
+      wake_up_interruptible(&dev->w_wait);
+    goto out;
+  }
+
+  if (size > dev->current_len)
+    size = dev->current_len;
+
+  if (globalfifo_ring_get(dev, buf, size)) {
+    ret = -EFAULT;
+    goto out;
+  } else {
+    log_debug("read %d bytes(s), current_len:%d\n", size, dev->current_len);
+
+    wake_up_interruptible(&dev->w_wait);
+    ret = size;
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+
+out2:
+  remove_wait_queue(&dev->r_wait, &wait);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write
+* Description: globalfifo write data
+* Input:       filp: struct file
+*              buf: write buffer
+*              size: write data size
+*              ppos: pos offset
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Append at the ring tail with wrap-around
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Queue each write as one length-prefixed record in record mode
+
+********************************************************************************************/
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos)
+{
+  ssize_t ret = 0;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+  unsigned int room = globalfifo_write_room(size);
+
+  DECLARE_WAITQUEUE(wait, current);
+
+  if (globalfifo_record) {
+    if (size == 0)
+      return 0;
+
+    if (size > GLOBALFIFO_MAX_RECORD)
+      return -EMSGSIZE;
+  }
+
+  mutex_lock(&dev->mutex);
+  add_wait_queue(&dev->w_wait, &wait);
+
+  while(GLOBALFIFO_SIZE - dev->current_len < room) {
+    if (filp->f_flags & O_NONBLOCK) {
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    __set_current_state(TASK_INTERRUPTIBLE);
+
+    mutex_unlock(&dev->mutex);
+    schedule();
+
+    if (signal_pending(current)) {
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+  }
+
+  if (globalfifo_record) {
+    ret = globalfifo_record_put(dev, buf, size);
+  } else {
+    if (size >= GLOBALFIFO_SIZE - dev->current_len)
+      size = GLOBALFIFO_SIZE - dev->current_len;
+
+    ret = globalfifo_ring_put(dev, buf, size) ? -EFAULT : size;
+  }
+
+  if (ret < 0)
+    goto out;
+
+  log_debug("written %zd bytes(s), current_len:%d\n", ret, dev->current_len);
+
+  wake_up_interruptible(&dev->r_wait);
+
+  if (dev->async_queue) {
+    kill_fasync(&dev->async_queue, SIGIO, POLL_IN);
+    log_debug("%s kill SIGIO\n", __func__);
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+out2:
+  remove_wait_queue(&dev->w_wait, &wait);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_llseek
+* Description: globalfifo llseek pos
+* Input:       filp: struct file
+*              offset: pos offse
+*              orig: pos flag
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig)
+{
+  loff_t ret = 0;
+  switch (orig) {
+  case 0:
+    if (offset < 0) {
+      ret = -EINVAL;
+      break;
+    }
+
+    if((unsigned int)offset > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }
+
+    filp->f_pos = (unsigned int)offset;
+    ret = filp->f_pos;
+    break;
+  case 1:
+    if ((filp->f_pos + offset) > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }  
+
+    if ((filp->f_pos + offset) < 0) {
+      ret = -EINVAL;
+      break;
+    }
+    filp->f_pos += offset;
+    ret = filp->f_pos;
+    break;
+
+  default:
+    ret = -EINVAL;
+    break;
+
+  }
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ioctl
+* Description: globalfifo ioctl
+* Input:       filp: struct file
+*              cmd: command
+*              arg: argue
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Drop all records on MEM_CLEAR_CMD, add FIFO_SET_BATCH_CMD
+
+********************************************************************************************/
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg)
+{
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  switch (cmd)
+  {
+  case MEM_CLEAR_CMD:
+    /* zeroing the buffer alone would turn the queued length headers into garbage */
+    mutex_lock(&dev->mutex);
+    memset(dev->mem, 0, GLOBALFIFO_SIZE);
+    dev->head = 0;
+    dev->tail = 0;
+    dev->current_len = 0;
+    mutex_unlock(&dev->mutex);
+
+    wake_up_interruptible(&dev->w_wait);
+    log_debug("globalfifo is set to zero\n");
+    break;
+
+  case FIFO_SET_BATCH_CMD:
+    gf->batch = !!arg;
+    break;
+  
+  default:
+    return -EINVAL;
+    break;
+  }
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_poll
+* Description: globalfifo poll
+* Input:       filp: struct file
+*              poll_table: poll table pointer
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Report POLLOUT only when at least a one byte record fits
+
+********************************************************************************************/
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait)
+{
+  unsigned int mask = 0;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  mutex_lock(&dev->mutex);
+  
+  poll_wait(filp, &dev->r_wait, wait);
+  poll_wait(filp, &dev->w_wait, wait);
+
+  if (dev->current_len != 0) {
+    mask |= POLLIN | POLLRDNORM;
+  }
+  
+  if (GLOBALFIFO_SIZE - dev->current_len >= globalfifo_write_room(1)) {
+    mask |= POLLOUT | POLLWRNORM;
+  }
+
+  mutex_unlock(&dev->mutex);
+
+  return mask;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_fasync
+* Description: globalfifo fasync
+* Input:       fd: file descriptor 
+*              filp: struct file
+*              mode: file mode
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_fasync(int fd, struct file * filp, int mode)
+{
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
+  return fasync_helper(fd, filp, mode, &dev->async_queue);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_open
+* Description: globalfifo open
+* Input:       inode: inode 
+* Output:      filp: strcut file
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Allocate the per file state
+
+********************************************************************************************/
+static int globalfifo_open(struct inode * inode, struct file * filp)
+{
+  struct globalfifo_file * gf;
+
+  gf = kzalloc(sizeof(struct globalfifo_file), GFP_KERNEL);
+  if (!gf)
+    return -ENOMEM;
+
+  gf->dev = globalfifo_devp;
+  filp->private_data = gf;
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_release
+* Description: globalfifo relesase
+* Input:       inode: inode 
+*              filp: strcut file
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Free the per file state
+
+********************************************************************************************/
+static int globalfifo_release(struct inode * inode, struct file *filp)
+{
+  globalfifo_fasync(-1, filp, 0);
+  kfree(filp->private_data);
+  
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_init
+* Description: globalfifo initial
+* Input:       Noen
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int __init globalfifo_init(void)
+{
+    int ret;
+
+    dev_t devno = MKDEV(globalfifo_major, 0);
+    
+    if (globalfifo_major) 
+      ret = register_chrdev_region(devno, 1, "globalfifo");
+    else {
+      ret = alloc_chrdev_region(&devno, 0, 1, "globalfifo");
+      globalfifo_major = MAJOR(devno);
+    }
+
+    if (ret < 0) 
+      return ret;
+
+    globalfifo_devp = kzalloc(sizeof(struct globalfifo_dev), GFP_KERNEL);
+    if (!globalfifo_devp) {
+      ret = -ENOMEM;
+      goto fail_malloc;
+    }
+
+    globalfifo_setup_cdev(globalfifo_devp, 0);
+    mutex_init(&globalfifo_devp->mutex);
+    init_waitqueue_head(&globalfifo_devp->r_wait);
+    init_waitqueue_head(&globalfifo_devp->w_wait);
+
+    return 0; 
+
+fail_malloc:
+    unregister_chrdev_region(devno, 1);
+    return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_exit
+* Description: globalfifo exit
+* Input:       Noen
+* Output:      None
+* Return:      None
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void __exit globalfifo_exit(void)
+{
+    cdev_del(&globalfifo_devp->cdev);
+    kfree(globalfifo_devp);
+    unregister_chrdev_region(MKDEV(globalfifo_major, 0), 1);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_setup_cdev
+* Description: globalfifo setup cdev struct 
+* Input:       index: cdev index node
+* Output:      dev: initialed cdev 
+* Return:      None
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index)
+{
+  int err, devno = MKDEV(globalfifo_major, index);
+
+  cdev_init(&dev->cdev, &globalfifo_fops);
+  dev->cdev.owner = THIS_MODULE;
+
+  err = cdev_add(&dev->cdev, devno, 1);
+  if (err) 
+    log_debug("Error %d adding globalfifo%d", err, index);
+
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_get
+* Description: copy data out of the ring to user space and advance the head index,
+*              the data may wrap around the end of mem[] so it is copied in two segments
+* Input:       dev: globalfifo device
+*              size: read data size, must not exceed current_len
+* Output:      buf: read buffer
+* Return:      0: execute success
+*              -EFAULT: copy to user failure, the ring is left untouched
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_ring_get(struct globalfifo_dev * dev, char __user * buf, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->head);
+
+  if (copy_to_user(buf, dev->mem + dev->head, first))
+    return -EFAULT;
+
+  if (copy_to_user(buf + first, dev->mem, size - first))
+    return -EFAULT;
+
+  dev->head = (dev->head + size) & GLOBALFIFO_MASK;
+  dev->current_len -= size;
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_put
+* Description: copy data from user space into the ring and advance the tail index,
+*              the free space may wrap around the end of mem[] so it is filled in two segments
+* Input:       dev: globalfifo device
+*              buf: write buffer
+*              size: write data size, must not exceed the free space
+* Output:      None
+* Return:      0: execute success
+*              -EFAULT: copy from user failure, the ring is left untouched
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_ring_put(struct globalfifo_dev * dev, const char __user * buf, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->tail);
+
+  if (copy_from_user(dev->mem + dev->tail, buf, first))
+    return -EFAULT;
+
+  if (copy_from_user(dev->mem, buf + first, size - first))
+    return -EFAULT;
+
+  dev->tail = (dev->tail + size) & GLOBALFIFO_MASK;
+  dev->current_len += size;
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_peek
+* Description: copy data out of the ring to kernel space without consuming it
+* Input:       dev: globalfifo device
+*              size: data size, must not exceed current_len
+* Output:      dst: kernel buffer
+* Return:      None
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_ring_peek(struct globalfifo_dev * dev, void * dst, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->head);
+
+  memcpy(dst, dev->mem + dev->head, first);
+  memcpy(dst + first, dev->mem, size - first);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_put_kernel
+* Description: copy data from kernel space into the ring and advance the tail index
+* Input:       dev: globalfifo device
+*              src: kernel buffer
+*              size: data size, must not exceed the free space
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_ring_put_kernel(struct globalfifo_dev * dev, const void * src, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->tail);
+
+  memcpy(dev->mem + dev->tail, src, first);
+  memcpy(dev->mem, src + first, size - first);
+
+  dev->tail = (dev->tail + size) & GLOBALFIFO_MASK;
+  dev->current_len += size;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_record_get
+* Description: dequeue whole records to user space
+* Input:       gf: per file state
+*              size: user buffer size
+* Output:      buf: read buffer
+* Return:      ssize_t: read data count
+*              -EMSGSIZE: the next record does not fit into buf, it stays queued
+*              -EFAULT: copy to user failure, the records stay queued
+* Others:      caller must hold dev->mutex and current_len must not be 0. Without batch
+*              only the payload of one record is returned, with batch as many records
+*              as fit are returned back to back, each preceded by its u32 length.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static ssize_t globalfifo_record_get(struct globalfifo_file * gf, char __user * buf, size_t size)
+{
+  u32 len;
+  size_t copied = 0;
+  struct globalfifo_dev * dev = gf->dev;
+  unsigned int head = dev->head;
+  unsigned int current_len = dev->current_len;
+
+  globalfifo_ring_peek(dev, &len, GLOBALFIFO_HDR_SIZE);
+
+  if (!gf->batch) {
+    if (len > size)
+      return -EMSGSIZE;
+
+    dev->head = (dev->head + GLOBALFIFO_HDR_SIZE) & GLOBALFIFO_MASK;
+    dev->current_len -= GLOBALFIFO_HDR_SIZE;
+    if (globalfifo_ring_get(dev, buf, len))
+      goto fault;
+
+    log_debug("read record of %u bytes(s), current_len:%d\n", len, dev->current_len);
+    return len;
+  }
+
+  if (GLOBALFIFO_HDR_SIZE + len > size)
+    return -EMSGSIZE;
+
+  do {
+    if (globalfifo_ring_get(dev, buf + copied, GLOBALFIFO_HDR_SIZE + len))
+      goto fault;
+
+    copied += GLOBALFIFO_HDR_SIZE + len;
+    if (dev->current_len == 0)
+      break;
+
+    globalfifo_ring_peek(dev, &len, GLOBALFIFO_HDR_SIZE);
+  } while (copied + GLOBALFIFO_HDR_SIZE + len <= size);
+
+  log_debug("read %zu bytes(s) of records, current_len:%d\n", copied, dev->current_len);
+  return copied;
+
+fault:
+  dev->head = head;
+  dev->current_len = current_len;
+  return -EFAULT;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_record_put
+* Description: enqueue one write as a length-prefixed record
+* Input:       dev: globalfifo device
+*              buf: write buffer
+*              size: record size, 1..GLOBALFIFO_MAX_RECORD
+* Output:      None
+* Return:      ssize_t: written data count
+*              -EFAULT: copy from user failure, nothing is queued
+* Others:      caller must hold dev->mutex and have waited for globalfifo_write_room(size)
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static ssize_t globalfifo_record_put(struct globalfifo_dev * dev, const char __user * buf, size_t size)
+{
+  u32 len = size;
+  unsigned int tail = dev->tail;
+  unsigned int current_len = dev->current_len;
+
+  globalfifo_ring_put_kernel(dev, &len, GLOBALFIFO_HDR_SIZE);
+
+  if (globalfifo_ring_put(dev, buf, len)) {
+    dev->tail = tail;
+    dev->current_len = current_len;
+    return -EFAULT;
+  }
+
+  return len;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write_room
+* Description: free space a writer has to wait for
+* Input:       size: write data size
+* Output:      None
+* Return:      unsigned int: required free bytes
+* Others:      a stream write proceeds as soon as one byte is free, a record needs
+*              room for its header and the whole payload
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static unsigned int globalfifo_write_room(size_t size)
+{
+  if (!globalfifo_record)
+    return 1;
+
+  return GLOBALFIFO_HDR_SIZE + min_t(size_t, size, GLOBALFIFO_MAX_RECORD);
+}
+
+
+/*
+  ** module declaration
+*/
+module_init(globalfifo_init);
+module_exit(globalfifo_exit);
+
+MODULE_AUTHOR("JexJiang");
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("A simple Hello World Module");
+MODULE_ALIAS("a simplest module");
+MODULE_VERSION("v1.0");
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
@@ -0,0 +1,111 @@
+/*
+  ** @file           : app_globalfifo_eventfd.c
+  ** @brief          : global fifo eventfd notification application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include 
+*/
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   FIFO_SET_RD_EVENTFD_CMD     (0x4)
+#define   MAX_LEN                     (100)
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list                
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+/* 
+  ** 为/dev/globalfifo注册一个eventfd，有数据到达时驱动对eventfd计数加1
+  ** 主循环只用epoll等待eventfd，不需要信号处理函数
+*/
+int main(int argc, char * argv[])
+{
+    int fd, efd, epfd, num;
+    uint64_t count;
+    char buf[MAX_LEN + 1];
+    struct epoll_event ev;
+
+    fd = open("/dev/globalfifo", O_RDONLY | O_NONBLOCK);
+    if (-1 == fd) {
+      log_debug("/dev/globalfifo open failure\r\n");
+      return -1;
+    }
+
+    efd = eventfd(0, EFD_NONBLOCK);
+    if (efd < 0) {
+      perror("eventfd()");
+      return -1;
+    }
+
+    if (ioctl(fd, FIFO_SET_RD_EVENTFD_CMD, efd) < 0) {
+      perror("ioctl()");
+      return -1;
+    }
+
+    epfd = epoll_create(1);
+    if (epfd < 0) {
+      perror("epoll_create()");
+      return -1;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.fd = efd;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, efd, &ev) < 0) {
+      perror("epoll_ctl()");
+      return -1;
+    }
+
+    while (1) {
+      if (epoll_wait(epfd, &ev, 1, -1) <= 0)
+        continue;
+
+      read(efd, &count, sizeof(count));
+
+      while ((num = read(fd, buf, MAX_LEN)) > 0) {
+        buf[num] = '\0';
+        log_debug("eventfd count:%llu, read:%s\r\n", (unsigned long long)count, buf);
+      }
+    }
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
@@ -15,8 +15,10 @@
 /*
   ** include 
 */
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <signal.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -31,21 +33,27 @@
 
 
 /********************************************************************************************
-* Function:    sigterm_handler
-* Description: signal handler function
-* Input:       signo: signal number           
+* Function:    signalio_drain
+* Description: read everything that is buffered in the fifo
+* Input:       fd: globalfifo file descriptor
 * Output:      None
 * Return:      None
-* Others:      
+* Others:      fd is non-blocking, reading also re-arms the POLL_IN signal in the driver
 * Revision history:
-             1.Date:     2022-1-30
+             1.Date:     2026-10-17
                Author:   JexJiang
                Modification: Function created
 
 ********************************************************************************************/
-static void signalio_handler(int signo)
+static void signalio_drain(int fd)
 {
-  log_debug("receiver a signal from globalfifo,signalnum:%d\r\n", signo);
+  char data[MAX_LEN];
+  ssize_t len;
+
+  while ((len = read(fd, data, sizeof(data) - 1)) > 0) {
+    data[len] = '\0';
+    log_debug("fd:%d read:%s\r\n", fd, data);
+  }
 }
 
 
@@ -62,28 +70,43 @@ static void signalio_handler(int signo)
              1.Date:     2022-1-30
                Author:   JexJiang
                Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Take queued real-time signals with sigwaitinfo()
 
 ********************************************************************************************/
 /* 
-  ** 对SIGIO信号安装input_handler()作为处理函数
-  ** 将本进程设置为STDIN_FILENO的文件拥有者
-  ** 启用异步通知机制时，需要对设备设置FASYNC标志
+  ** 用F_SETSIG把异步通知换成实时信号SIGRTMIN，信号不再合并而是排队
+  ** siginfo中的si_fd指出是哪个文件，si_band区分POLL_IN(可读)和POLL_OUT(可写)
+  ** 阻塞SIGRTMIN后用sigwaitinfo()同步取信号，可以在一个循环里处理多个fifo
 */
 int main(int argc, char * argv[])
 {
     int fd, oflags;
+    sigset_t set;
+    siginfo_t info;
     
     fd = open("/dev/globalfifo", O_RDWR, S_IRUSR | S_IWUSR);
     if (-1 != fd) {
-      signal(SIGIO, signalio_handler);
-      
+      sigemptyset(&set);
+      sigaddset(&set, SIGRTMIN);
+      sigprocmask(SIG_BLOCK, &set, NULL);
+
       fcntl(fd, F_SETOWN, getpid());
+      fcntl(fd, F_SETSIG, SIGRTMIN);
       oflags = fcntl(fd, F_GETFL);
-      fcntl(fd, F_SETFL, oflags | FASYNC);
+      fcntl(fd, F_SETFL, oflags | FASYNC | O_NONBLOCK);
 
       while(1) 
       {
-        sleep(1);
+        if (sigwaitinfo(&set, &info) < 0)
+          continue;
+
+        log_debug("receiver a signal from globalfifo,signalnum:%d, fd:%d, band:0x%lx\r\n",
+                  info.si_signo, info.si_fd, (long)info.si_band);
+
+        if (info.si_band & POLLIN)
+          signalio_drain(info.si_fd);
       }
     } else {
       log_debug("/dev/globalfifo open failure\r\n");
@@ -27,13 +27,27 @@
 #include <linux/sched/signal.h>
 #include <linux/memory.h>
 #include <linux/poll.h>
+#include <linux/timekeeping.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/sched/clock.h>
+#include <linux/eventfd.h>
+#include <linux/version.h>
 
 
 /*
   ** define
 */
 #define     GLOBALFIFO_SIZE         (0x1000)
+#define     GLOBALFIFO_MASK         (GLOBALFIFO_SIZE - 1)
 #define     MEM_CLEAR_CMD           (0x1)
+#define     FIFO_SET_RCVLOWAT_CMD   (0x2)
+#define     FIFO_SET_SNDLOWAT_CMD   (0x3)
+#define     FIFO_SET_RD_EVENTFD_CMD (0x4)
+#define     FIFO_SET_WR_EVENTFD_CMD (0x5)
+#define     FIFO_SET_ATOMIC_CMD     (0x6)
+#define     FIFO_SET_BUSY_POLL_CMD  (0x7)
+#define     GLOBALFIFO_BUSY_POLL_MAX (10000)
 #define     GLOBALFIFO_MAJOR        (230)
 
 #define     log_debug(fmt, ...)     printk(KERN_DEBUG   pr_fmt(fmt), ##__VA_ARGS__)
@@ -45,18 +59,102 @@
 #define     log_alert(fmt, ...)     printk(KERN_ALERT   pr_fmt(fmt), ##__VA_ARGS__)
 #define     log_emerg(fmt, ...)     printk(KERN_EMERG   pr_fmt(fmt), ##__VA_ARGS__)
 
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 8, 0)
+#define     globalfifo_eventfd_signal(ctx)  eventfd_signal(ctx)
+#else
+#define     globalfifo_eventfd_signal(ctx)  eventfd_signal(ctx, 1)
+#endif
+
 
 /*
   ** struct
 */
+
+/*
+  ** counters exported through /sys/kernel/debug/globalfifo/stats, the rd_* ones are
+  ** protected by dev->rd_mutex, the others by dev->wr_mutex. A sleep is counted when it
+  ** starts, its time once the sleeper holds the mutex again, so a sleep cut short by a
+  ** signal adds no time.
+*/
+struct globalfifo_stats {
+  u64 rd_bytes;
+  u64 rd_sleeps;
+  u64 rd_sleep_ns;
+  u64 rd_eagain;
+  u64 rd_busy_polls;
+  u64 rd_busy_hits;
+  u64 wr_bytes;
+  u64 wr_sleeps;
+  u64 wr_sleep_ns;
+  u64 wr_eagain;
+  unsigned int max_len;
+};
+
+/*
+  ** lock is only held to update head, tail and current_len, never across a user copy
+  ** or a wakeup. rd_mutex serializes the readers and wr_mutex the writers, each side
+  ** copies its reserved range with its own mutex held, so one reader and one writer
+  ** run in parallel. mutex protects the open file list and the watermark minimums.
+  ** notify_files counts the open files with FASYNC or an eventfd, it only changes under
+  ** mutex, read() and write() skip mutex and the file walk while it is 0.
+*/
 struct globalfifo_dev {
   struct cdev cdev;
+  spinlock_t lock;
   unsigned int current_len;
+  unsigned int head;
+  unsigned int tail;
   unsigned char mem[GLOBALFIFO_SIZE];
   struct mutex mutex;
+  struct mutex rd_mutex;
+  struct mutex wr_mutex;
   wait_queue_head_t r_wait;
   wait_queue_head_t w_wait;
+  struct list_head files;
+  unsigned int notify_files;
+  unsigned int rcvlowat_min;
+  unsigned int sndlowat_min;
+  struct globalfifo_stats stats;
+  struct dentry * debugfs;
+};
+
+/*
+  ** per open file state, rcvlowat/sndlowat are the low watermarks of this file:
+  ** a read blocks and POLLIN stays clear until rcvlowat bytes are buffered, a write
+  ** blocks and POLLOUT stays clear until sndlowat bytes are free, SIGIO is only sent
+  ** to this file once rcvlowat bytes are buffered. rd_eventfd/wr_eventfd are signalled
+  ** under the same watermarks when data arrives or space is freed.
+  ** rd_sig_pending/wr_sig_pending mark a POLL_IN/POLL_OUT signal that was sent and not
+  ** yet acted upon, see globalfifo_notify_readers(). notify tells whether this file is
+  ** counted in dev->notify_files.
+  ** atomic works like PIPE_BUF: a write of up to atomic bytes is never split, 0 turns it off.
+  ** POLLOUT, POLL_OUT and the write eventfd then also wait for atomic free bytes.
+  ** busy_poll is how long a blocking read spins for data before it sleeps, in us.
+*/
+struct globalfifo_file {
+  struct globalfifo_dev * dev;
+  struct list_head list;
+  fmode_t mode;
+  unsigned int rcvlowat;
+  unsigned int sndlowat;
+  unsigned int atomic;
+  unsigned int busy_poll;
   struct fasync_struct * async_queue;
+  struct eventfd_ctx * rd_eventfd;
+  struct eventfd_ctx * wr_eventfd;
+  bool rd_sig_pending;
+  bool wr_sig_pending;
+  bool notify;
+};
+
+/*
+  ** wait queue entry of a blocked reader or writer, see globalfifo_read_wake(),
+  ** size is the length of a blocked write
+*/
+struct globalfifo_waiter {
+  wait_queue_entry_t wq;
+  struct globalfifo_file * gf;
+  size_t size;
 };
 
 
@@ -71,7 +169,20 @@ static unsigned int globalfifo_poll(struct file * filp, poll_table * wait);
 static int globalfifo_open(struct inode * inode, struct file * filp);
 static int globalfifo_release(struct inode * inode, struct file *filp);
 static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index);
+static void globalfifo_update_lowat(struct globalfifo_dev * dev);
+static unsigned int globalfifo_write_need(struct globalfifo_file * gf, size_t size);
+static bool globalfifo_busy_wait(struct globalfifo_file * gf);
+static int globalfifo_stats_show(struct seq_file * s, void * unused);
+static int globalfifo_stats_reset(void * data, u64 val);
+static int globalfifo_read_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key);
+static int globalfifo_write_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key);
+static int globalfifo_ring_get(struct globalfifo_dev * dev, char __user * buf, unsigned int size);
+static int globalfifo_ring_put(struct globalfifo_dev * dev, const char __user * buf, unsigned int size);
 static int globalfifo_fasync(int fd, struct file * filp, int mode);
+static void globalfifo_notify_readers(struct globalfifo_dev * dev);
+static void globalfifo_notify_writers(struct globalfifo_dev * dev);
+static void globalfifo_update_notify(struct globalfifo_file * gf);
+static int globalfifo_set_eventfd(struct globalfifo_file * gf, unsigned int cmd, int fd);
 
 
 /*
@@ -89,6 +200,10 @@ static const struct file_operations globalfifo_fops = {
   .release = globalfifo_release,
 };
 
+/* debugfs files, defined here so globalfifo_init() can use them */
+DEFINE_SHOW_ATTRIBUTE(globalfifo_stats);
+DEFINE_DEBUGFS_ATTRIBUTE(globalfifo_reset_fops, NULL, globalfifo_stats_reset, "%llu\n");
+
 
 /*
   ** static global variable
@@ -96,6 +211,10 @@ static const struct file_operations globalfifo_fops = {
 static int globalfifo_major = GLOBALFIFO_MAJOR;
 module_param(globalfifo_major, int, S_IRUGO);
 
+/* busy poll budget in us of newly opened files, like net.core.busy_read */
+static unsigned int globalfifo_busy_read;
+module_param(globalfifo_busy_read, uint, S_IRUGO | S_IWUSR);
+
 struct globalfifo_dev * globalfifo_devp;
 
 
@@ -116,58 +235,152 @@ struct globalfifo_dev * globalfifo_devp;
              1.Date:     2022-1-24
                Author:   JexJiang
                Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Read from the ring head instead of shifting the buffer
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Block until the per file rcvlowat is reached
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Sleep as an exclusive waiter
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Signal the write eventfds when space is freed
+             6.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Re-arm the POLL_IN signal of the reading file
+             7.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Count sleeps, time asleep, EAGAIN returns and bytes read
+             8.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Busy poll for up to gf->busy_poll us before sleeping
+             9.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Copy out under rd_mutex, update the indices under dev->lock and wake with no lock held
+             10.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Skip dev->mutex and the notify walk while no file has FASYNC or an eventfd
 
 ********************************************************************************************/
 static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos)
 {
   int ret = 0;
-  struct globalfifo_dev *dev = filp->private_data;
+  bool woken = false, spun = false, hit;
+  unsigned int len = 0;
+  u64 start;
+  struct globalfifo_file *gf = filp->private_data;
+  struct globalfifo_dev *dev = gf->dev;
+  struct globalfifo_waiter wait = { .gf = gf };
+
+  init_waitqueue_func_entry(&wait.wq, globalfifo_read_wake);
+  wait.wq.private = current;
+
+  mutex_lock(&dev->rd_mutex);
+  add_wait_queue_exclusive(&dev->r_wait, &wait.wq);
+
+  while (1) {
+    /* writers do not take rd_mutex, so the state is set before the check like in wait_event() */
+    set_current_state(TASK_INTERRUPTIBLE);
+    if (READ_ONCE(dev->current_len) >= READ_ONCE(gf->rcvlowat))
+      break;
 
-  DECLARE_WAITQUEUE(wait, current);
+    if (filp->f_flags & O_NONBLOCK) {
+      __set_current_state(TASK_RUNNING);
 
-  mutex_lock(&dev->mutex);
-  add_wait_queue(&dev->r_wait, &wait);
+      /* like SO_RCVLOWAT a non-blocking read takes whatever is there */
+      if (READ_ONCE(dev->current_len) != 0)
+        break;
 
-  while(dev->current_len == 0) {
-    if (filp->f_flags & O_NONBLOCK) {
+      dev->stats.rd_eagain++;
       ret = -EAGAIN;
       goto out;
     }
 
-    __set_current_state(TASK_INTERRUPTIBLE);
-    mutex_unlock(&dev->mutex);
+    /* spin once for up to busy_poll us before paying for a sleep and a wakeup */
+    if (gf->busy_poll && !spun) {
+      __set_current_state(TASK_RUNNING);
+      spun = true;
+      dev->stats.rd_busy_polls++;
+      mutex_unlock(&dev->rd_mutex);
+
+      hit = globalfifo_busy_wait(gf);
+
+      mutex_lock(&dev->rd_mutex);
+      if (hit)
+        dev->stats.rd_busy_hits++;
+      continue;
+    }
+
+    dev->stats.rd_sleeps++;
+    start = ktime_get_ns();
+    mutex_unlock(&dev->rd_mutex);
 
     schedule();
+    woken = true;
     if(signal_pending(current)) {
+      /* do not swallow an exclusive wakeup meant for the next reader */
+      wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
       ret = -ERESTARTSYS;
       goto out2;
     }
 
-    mutex_lock(&dev->mutex);
+    mutex_lock(&dev->rd_mutex);
+    dev->stats.rd_sleep_ns += ktime_get_ns() - start;
   }
+  __set_current_state(TASK_RUNNING);
+
+  /* reserve: only readers consume, so the bytes buffered now stay ours until the commit */
+  spin_lock(&dev->lock);
+  len = dev->current_len;
+  spin_unlock(&dev->lock);
 
-  if (size > dev->current_len)
-    size = dev->current_len;
+  if (size > len)
+    size = len;
 
-  if (copy_to_user(buf, dev->mem, size)) {
+  /* writers keep filling the free space while the data is copied out */
+  if (globalfifo_ring_get(dev, buf, size)) {
     ret = -EFAULT;
     goto out;
-  } else {
-    memcpy(dev->mem, dev->mem + size, dev->current_len - size);
-    dev->current_len -= size;
-    log_debug("read %d bytes(s), current_len:%d\n", size, dev->current_len);
-
-    wake_up_interruptible(&dev->w_wait);
-    ret = size;
   }
 
+  /* commit */
+  spin_lock(&dev->lock);
+  dev->head = (dev->head + size) & GLOBALFIFO_MASK;
+  len = dev->current_len - size;
+  WRITE_ONCE(dev->current_len, len);
+  spin_unlock(&dev->lock);
+
+  log_debug("read %d bytes(s), current_len:%d\n", size, len);
+  dev->stats.rd_bytes += size;
+  ret = size;
+
 out:
-  mutex_unlock(&dev->mutex);
+  mutex_unlock(&dev->rd_mutex);
 
 out2:
-  remove_wait_queue(&dev->w_wait, &wait);
+  remove_wait_queue(&dev->r_wait, &wait.wq);
   set_current_state(TASK_RUNNING);
 
+  /* wake up with no lock held, so the woken tasks do not block on it right away */
+  if (ret > 0) {
+    if (GLOBALFIFO_SIZE - len >= READ_ONCE(dev->sndlowat_min))
+      wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
+
+    /* only one reader was woken, hand the rest of the data to the next one */
+    if (woken && len >= READ_ONCE(dev->rcvlowat_min))
+      wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
+
+    /* this file acted on its POLL_IN, the next arrival may signal it again */
+    if (READ_ONCE(dev->notify_files)) {
+      mutex_lock(&dev->mutex);
+      gf->rd_sig_pending = false;
+      globalfifo_notify_writers(dev);
+      mutex_unlock(&dev->mutex);
+    }
+  }
+
   return ret;
 }
 
@@ -186,63 +399,137 @@ out2:
              1.Date:     2022-1-24
                Author:   JexJiang
                Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Append at the ring tail with wrap-around
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Block until the per file sndlowat is free
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Sleep as an exclusive waiter
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Notify SIGIO and eventfd listeners through globalfifo_notify_readers()
+             6.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Re-arm the POLL_OUT signal of the writing file
+             7.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Count sleeps, time asleep, EAGAIN returns, bytes written and max_len
+             8.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Never split writes of up to gf->atomic bytes
+             9.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Copy in under wr_mutex, update the indices under dev->lock and wake with no lock held
+             10.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Skip dev->mutex and the notify walk while no file has FASYNC or an eventfd
 
 ********************************************************************************************/
 static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos)
 {
   int ret = 0;
-  struct globalfifo_dev * dev = filp->private_data;
+  bool woken = false;
+  unsigned int len = 0;
+  u64 start;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+  struct globalfifo_waiter wait = { .gf = gf, .size = size };
+
+  init_waitqueue_func_entry(&wait.wq, globalfifo_write_wake);
+  wait.wq.private = current;
+
+  mutex_lock(&dev->wr_mutex);
+  add_wait_queue_exclusive(&dev->w_wait, &wait.wq);
+
+  while (1) {
+    set_current_state(TASK_INTERRUPTIBLE);
+    len = READ_ONCE(dev->current_len);
+    if (GLOBALFIFO_SIZE - len >= globalfifo_write_need(gf, size))
+      break;
 
-  DECLARE_WAITQUEUE(wait, current);
+    if (filp->f_flags & O_NONBLOCK) {
+      __set_current_state(TASK_RUNNING);
 
-  mutex_lock(&dev->mutex);
-  add_wait_queue(&dev->w_wait, &wait);
+      /* an atomic write goes in whole or not at all */
+      if (size <= READ_ONCE(gf->atomic)) {
+        if (GLOBALFIFO_SIZE - len >= size)
+          break;
+      } else if (len != GLOBALFIFO_SIZE) {
+        break;
+      }
 
-  while(dev->current_len == GLOBALFIFO_SIZE) {
-    if (filp->f_flags & O_NONBLOCK) {
+      dev->stats.wr_eagain++;
       ret = -EAGAIN;
       goto out;
     }
 
-    __set_current_state(TASK_INTERRUPTIBLE);
+    dev->stats.wr_sleeps++;
+    start = ktime_get_ns();
 
-    mutex_unlock(&dev->mutex);
+    mutex_unlock(&dev->wr_mutex);
     schedule();
+    woken = true;
 
     if (signal_pending(current)) {
+      wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
       ret = -ERESTARTSYS;
       goto out2;
     }
 
-    mutex_lock(&dev->mutex);
+    mutex_lock(&dev->wr_mutex);
+    dev->stats.wr_sleep_ns += ktime_get_ns() - start;
   }
+  __set_current_state(TASK_RUNNING);
 
-  if (size >= GLOBALFIFO_SIZE - dev->current_len)
-    size = GLOBALFIFO_SIZE - dev->current_len;
+  /* reserve: only writers produce, so the free space seen now stays ours until the commit */
+  spin_lock(&dev->lock);
+  len = dev->current_len;
+  spin_unlock(&dev->lock);
 
-  if (copy_from_user(dev->mem + dev->current_len, buf, size)) {
+  if (size >= GLOBALFIFO_SIZE - len)
+    size = GLOBALFIFO_SIZE - len;
+
+  if (globalfifo_ring_put(dev, buf, size)) {
     ret = -EFAULT;
     goto out;
-  } else {
-    dev->current_len += size;
-    log_debug("written %u bytes(s), current_len:%d\n", size, dev->current_len);
-
-    wake_up_interruptible(&dev->r_wait);
+  }
 
-    if (dev->async_queue) {
-      kill_fasync(&dev->async_queue, SIGIO, POLL_IN);
-      log_debug("%s kill SIGIO\n", __func__);
-    }
+  /* commit, the data is visible to readers once current_len covers it */
+  spin_lock(&dev->lock);
+  dev->tail = (dev->tail + size) & GLOBALFIFO_MASK;
+  len = dev->current_len + size;
+  WRITE_ONCE(dev->current_len, len);
+  spin_unlock(&dev->lock);
 
-    ret = size;
-  }
+  log_debug("written %u bytes(s), current_len:%d\n", size, len);
+  dev->stats.wr_bytes += size;
+  dev->stats.max_len = max(dev->stats.max_len, len);
+  ret = size;
 
 out:
-  mutex_unlock(&dev->mutex);
+  mutex_unlock(&dev->wr_mutex);
 out2:
-  remove_wait_queue(&dev->w_wait, &wait);
+  remove_wait_queue(&dev->w_wait, &wait.wq);
   set_current_state(TASK_RUNNING);
 
+  if (ret > 0) {
+    if (len >= READ_ONCE(dev->rcvlowat_min))
+      wake_up_interruptible_poll(&dev->r_wait, POLLIN | POLLRDNORM);
+
+    if (woken && GLOBALFIFO_SIZE - len >= READ_ONCE(dev->sndlowat_min))
+      wake_up_interruptible_poll(&dev->w_wait, POLLOUT | POLLWRNORM);
+
+    if (READ_ONCE(dev->notify_files)) {
+      mutex_lock(&dev->mutex);
+      gf->wr_sig_pending = false;
+      globalfifo_notify_readers(dev);
+      mutex_unlock(&dev->mutex);
+    }
+  }
+
   return ret;
 }
 
@@ -317,11 +604,24 @@ static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig)
              1.Date:     2022-1-24
                Author:   JexJiang
                Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_RCVLOWAT_CMD and FIFO_SET_SNDLOWAT_CMD
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_RD_EVENTFD_CMD and FIFO_SET_WR_EVENTFD_CMD
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_ATOMIC_CMD
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Add FIFO_SET_BUSY_POLL_CMD
 
 ********************************************************************************************/
 static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg)
 {
-  struct globalfifo_dev * dev = filp->private_data;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
 
   switch (cmd)
   {
@@ -329,6 +629,49 @@ static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long
     memset(dev->mem, 0, GLOBALFIFO_SIZE);
     log_debug("globalfifo is set to zero\n");
     break;
+
+  case FIFO_SET_RCVLOWAT_CMD:
+  case FIFO_SET_SNDLOWAT_CMD:
+    /* like SO_RCVLOWAT, 0 means 1 and the watermark cannot exceed the capacity */
+    if (arg > GLOBALFIFO_SIZE)
+      return -EINVAL;
+
+    mutex_lock(&dev->mutex);
+    if (cmd == FIFO_SET_RCVLOWAT_CMD)
+      gf->rcvlowat = max_t(unsigned int, arg, 1);
+    else
+      gf->sndlowat = max_t(unsigned int, arg, 1);
+    globalfifo_update_lowat(dev);
+    mutex_unlock(&dev->mutex);
+
+    /* a lowered watermark may already be satisfied for any of the sleepers */
+    wake_up_interruptible_all(&dev->r_wait);
+    wake_up_interruptible_all(&dev->w_wait);
+    break;
+
+  case FIFO_SET_ATOMIC_CMD:
+    if (arg > GLOBALFIFO_SIZE)
+      return -EINVAL;
+
+    mutex_lock(&dev->mutex);
+    WRITE_ONCE(gf->atomic, arg);
+    mutex_unlock(&dev->mutex);
+
+    /* blocked writes of this file may need less or more space now */
+    wake_up_interruptible_all(&dev->w_wait);
+    break;
+
+  case FIFO_SET_BUSY_POLL_CMD:
+    /* like SO_BUSY_POLL, in us, 0 turns it off */
+    if (arg > GLOBALFIFO_BUSY_POLL_MAX)
+      return -EINVAL;
+
+    WRITE_ONCE(gf->busy_poll, arg);
+    break;
+
+  case FIFO_SET_RD_EVENTFD_CMD:
+  case FIFO_SET_WR_EVENTFD_CMD:
+    return globalfifo_set_eventfd(gf, cmd, (int)arg);
   
   default:
     return -EINVAL;
@@ -351,28 +694,44 @@ static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long
              1.Date:     2022-1-24
                Author:   JexJiang
                Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Report readiness against the per file watermarks
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Compute the mask without dev->mutex
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Report POLLOUT only when an atomic write fits
 
 ********************************************************************************************/
 static unsigned int globalfifo_poll(struct file * filp, poll_table * wait)
 {
   unsigned int mask = 0;
-  struct globalfifo_dev * dev = filp->private_data;
+  unsigned int len;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
 
-  mutex_lock(&dev->mutex);
-  
   poll_wait(filp, &dev->r_wait, wait);
   poll_wait(filp, &dev->w_wait, wait);
 
-  if (dev->current_len != 0) {
+  /*
+    ** no dev->mutex here: poll_wait() queued us under the wait queue lock before the
+    ** load below, and read()/write() update current_len before they take the same
+    ** lock to wake us, so either the new length is seen here or the wakeup finds us.
+    ** Every transition across a watermark issues a wakeup, which keeps EPOLLET safe.
+  */
+  len = READ_ONCE(dev->current_len);
+
+  if (len >= READ_ONCE(gf->rcvlowat)) {
     mask |= POLLIN | POLLRDNORM;
   }
   
-  if (dev->current_len != GLOBALFIFO_SIZE) {
+  /* like a pipe, POLLOUT promises room for one atomic write */
+  if (GLOBALFIFO_SIZE - len >= globalfifo_write_need(gf, READ_ONCE(gf->atomic))) {
     mask |= POLLOUT | POLLWRNORM;
   }
 
-  mutex_unlock(&dev->mutex);
-
   return mask;
 }
 
@@ -390,13 +749,26 @@ static unsigned int globalfifo_poll(struct file * filp, poll_table * wait)
              1.Date:     2022-1-24
                Author:   JexJiang
                Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Keep the fasync list per open file
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Keep dev->notify_files up to date
 
 ********************************************************************************************/
 static int globalfifo_fasync(int fd, struct file * filp, int mode)
 {
-  struct globalfifo_dev * dev = filp->private_data;
+  int ret;
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
 
-  return fasync_helper(fd, filp, mode, &dev->async_queue);
+  mutex_lock(&dev->mutex);
+  ret = fasync_helper(fd, filp, mode, &gf->async_queue);
+  globalfifo_update_notify(gf);
+  mutex_unlock(&dev->mutex);
+
+  return ret;
 }
 
 
@@ -412,11 +784,35 @@ static int globalfifo_fasync(int fd, struct file * filp, int mode)
              1.Date:     2022-1-24
                Author:   JexJiang
                Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Allocate the per file state
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Take the busy poll budget from globalfifo_busy_read
 
 ********************************************************************************************/
 static int globalfifo_open(struct inode * inode, struct file * filp)
 {
-  filp->private_data = globalfifo_devp;
+  struct globalfifo_file * gf;
+  struct globalfifo_dev * dev = globalfifo_devp;
+
+  gf = kzalloc(sizeof(struct globalfifo_file), GFP_KERNEL);
+  if (!gf)
+    return -ENOMEM;
+
+  gf->dev = dev;
+  gf->mode = filp->f_mode;
+  gf->rcvlowat = 1;
+  gf->sndlowat = 1;
+  gf->busy_poll = min_t(unsigned int, READ_ONCE(globalfifo_busy_read), GLOBALFIFO_BUSY_POLL_MAX);
+
+  mutex_lock(&dev->mutex);
+  list_add(&gf->list, &dev->files);
+  globalfifo_update_lowat(dev);
+  mutex_unlock(&dev->mutex);
+
+  filp->private_data = gf;
   return 0;
 }
 
@@ -434,12 +830,37 @@ static int globalfifo_open(struct inode * inode, struct file * filp)
              1.Date:     2022-1-24
                Author:   JexJiang
                Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Free the per file state
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Drop the registered eventfds
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Uncount the file in dev->notify_files
 
 ********************************************************************************************/
 static int globalfifo_release(struct inode * inode, struct file *filp)
 {
+  struct globalfifo_file * gf = filp->private_data;
+  struct globalfifo_dev * dev = gf->dev;
+
   globalfifo_fasync(-1, filp, 0);
-  
+
+  mutex_lock(&dev->mutex);
+  list_del(&gf->list);
+  globalfifo_update_lowat(dev);
+  if (gf->notify)
+    WRITE_ONCE(dev->notify_files, dev->notify_files - 1);
+  mutex_unlock(&dev->mutex);
+
+  if (gf->rd_eventfd)
+    eventfd_ctx_put(gf->rd_eventfd);
+  if (gf->wr_eventfd)
+    eventfd_ctx_put(gf->wr_eventfd);
+  kfree(gf);
+
   return 0;
 }
 
@@ -456,6 +877,15 @@ static int globalfifo_release(struct inode * inode, struct file *filp)
              1.Date:     2022-1-24
                Author:   JexJiang
                Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Initialize the open file list
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Export the counters through debugfs
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Initialize dev->lock, rd_mutex and wr_mutex
 
 ********************************************************************************************/
 static int __init globalfifo_init(void)
@@ -481,9 +911,22 @@ static int __init globalfifo_init(void)
     }
 
     globalfifo_setup_cdev(globalfifo_devp, 0);
+    spin_lock_init(&globalfifo_devp->lock);
     mutex_init(&globalfifo_devp->mutex);
+    mutex_init(&globalfifo_devp->rd_mutex);
+    mutex_init(&globalfifo_devp->wr_mutex);
     init_waitqueue_head(&globalfifo_devp->r_wait);
     init_waitqueue_head(&globalfifo_devp->w_wait);
+    INIT_LIST_HEAD(&globalfifo_devp->files);
+    globalfifo_devp->rcvlowat_min = 1;
+    globalfifo_devp->sndlowat_min = 1;
+
+    /* debugfs is optional, errors are ignored like everywhere else in the kernel */
+    globalfifo_devp->debugfs = debugfs_create_dir("globalfifo", NULL);
+    debugfs_create_file("stats", S_IRUGO, globalfifo_devp->debugfs,
+                        globalfifo_devp, &globalfifo_stats_fops);
+    debugfs_create_file_unsafe("reset", S_IWUSR, globalfifo_devp->debugfs,
+                               globalfifo_devp, &globalfifo_reset_fops);
 
     return 0; 
 
@@ -504,10 +947,14 @@ fail_malloc:
              1.Date:     2022-1-24
                Author:   JexJiang
                Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Remove the debugfs directory
 
 ********************************************************************************************/
 static void __exit globalfifo_exit(void)
 {
+    debugfs_remove_recursive(globalfifo_devp->debugfs);
     cdev_del(&globalfifo_devp->cdev);
     kfree(globalfifo_devp);
     unregister_chrdev_region(MKDEV(globalfifo_major, 0), 1);
@@ -541,6 +988,508 @@ static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index)
 }
 
 
+/********************************************************************************************
+* Function:    globalfifo_ring_get
+* Description: copy data out of the ring to user space starting at the head index,
+*              the data may wrap around the end of mem[] so it is copied in two segments
+* Input:       dev: globalfifo device
+*              size: read data size, must not exceed current_len
+* Output:      buf: read buffer
+* Return:      0: execute success
+*              -EFAULT: copy to user failure, the ring is left untouched
+* Others:      caller must hold dev->rd_mutex and commits the range afterwards, head and
+*              current_len are only advanced under dev->lock
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Leave the head index to the caller
+
+********************************************************************************************/
+static int globalfifo_ring_get(struct globalfifo_dev * dev, char __user * buf, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->head);
+
+  if (copy_to_user(buf, dev->mem + dev->head, first))
+    return -EFAULT;
+
+  if (copy_to_user(buf + first, dev->mem, size - first))
+    return -EFAULT;
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_put
+* Description: copy data from user space into the ring starting at the tail index,
+*              the free space may wrap around the end of mem[] so it is filled in two segments
+* Input:       dev: globalfifo device
+*              buf: write buffer
+*              size: write data size, must not exceed the free space
+* Output:      None
+* Return:      0: execute success
+*              -EFAULT: copy from user failure, the ring is left untouched
+* Others:      caller must hold dev->wr_mutex and commits the range afterwards, readers
+*              do not look at the free space so the copy needs no other lock
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Leave the tail index to the caller
+
+********************************************************************************************/
+static int globalfifo_ring_put(struct globalfifo_dev * dev, const char __user * buf, unsigned int size)
+{
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - dev->tail);
+
+  if (copy_from_user(dev->mem + dev->tail, buf, first))
+    return -EFAULT;
+
+  if (copy_from_user(dev->mem, buf + first, size - first))
+    return -EFAULT;
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_update_lowat
+* Description: recompute the smallest low watermarks of the open readers and writers
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. Readers are only woken once current_len reaches
+*              rcvlowat_min and writers once the free space reaches sndlowat_min, no
+*              sleeper can be satisfied below those levels. read()/write() look at the
+*              minimums without dev->mutex, so only final values are published.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Publish the minimums with WRITE_ONCE()
+
+********************************************************************************************/
+static void globalfifo_update_lowat(struct globalfifo_dev * dev)
+{
+  struct globalfifo_file * gf;
+  unsigned int rcvlowat = GLOBALFIFO_SIZE;
+  unsigned int sndlowat = GLOBALFIFO_SIZE;
+
+  list_for_each_entry(gf, &dev->files, list) {
+    if (gf->mode & FMODE_READ)
+      rcvlowat = min(rcvlowat, gf->rcvlowat);
+    if (gf->mode & FMODE_WRITE)
+      sndlowat = min(sndlowat, gf->sndlowat);
+  }
+
+  WRITE_ONCE(dev->rcvlowat_min, rcvlowat);
+  WRITE_ONCE(dev->sndlowat_min, sndlowat);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_read_wake
+* Description: wake function of a reader sleeping on r_wait
+* Input:       wq: wait queue entry embedded in struct globalfifo_waiter
+*              mode: task state to wake
+*              sync: sync wakeup hint
+*              key: poll mask of the event
+* Output:      None
+* Return:      0: the reader cannot make progress yet and stays asleep
+*              other: the reader was woken
+* Others:      readers sleep as exclusive waiters, so a wakeup is only counted against
+*              the one-reader limit when it goes to a reader whose rcvlowat is reached
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_read_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key)
+{
+  struct globalfifo_waiter * w = container_of(wq, struct globalfifo_waiter, wq);
+
+  if (READ_ONCE(w->gf->dev->current_len) < READ_ONCE(w->gf->rcvlowat))
+    return 0;
+
+  return default_wake_function(wq, mode, sync, key);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write_wake
+* Description: wake function of a writer sleeping on w_wait
+* Input:       wq: wait queue entry embedded in struct globalfifo_waiter
+*              mode: task state to wake
+*              sync: sync wakeup hint
+*              key: poll mask of the event
+* Output:      None
+* Return:      0: the writer cannot make progress yet and stays asleep
+*              other: the writer was woken
+* Others:      mirror of globalfifo_read_wake()
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Wait for the whole of an atomic write
+
+********************************************************************************************/
+static int globalfifo_write_wake(wait_queue_entry_t * wq, unsigned int mode, int sync, void * key)
+{
+  struct globalfifo_waiter * w = container_of(wq, struct globalfifo_waiter, wq);
+
+  if (GLOBALFIFO_SIZE - READ_ONCE(w->gf->dev->current_len) < globalfifo_write_need(w->gf, w->size))
+    return 0;
+
+  return default_wake_function(wq, mode, sync, key);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_notify_readers
+* Description: asynchronous notification that data arrived
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex, current_len is sampled once since read() and
+*              write() change it without that mutex. Every open file whose rcvlowat is reached
+*              gets SIGIO if it enabled FASYNC and an eventfd count if it registered one.
+*              The signal carries POLL_IN, so with F_SETSIG send_sigio() queues the chosen
+*              real-time signal with si_fd and si_band filled in. Real-time signals queue
+*              one entry per kill, so a file is signalled once and then skipped until it
+*              reads or the fifo drops below its rcvlowat again. Writers that were told
+*              POLL_OUT are re-armed once the free space falls below their sndlowat.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Coalesce POLL_IN signals while one is pending
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Re-arm POLL_OUT against the atomic size
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Sample current_len once, it changes without dev->mutex
+
+********************************************************************************************/
+static void globalfifo_notify_readers(struct globalfifo_dev * dev)
+{
+  struct globalfifo_file * gf;
+  unsigned int len = READ_ONCE(dev->current_len);
+
+  list_for_each_entry(gf, &dev->files, list) {
+    if (GLOBALFIFO_SIZE - len < globalfifo_write_need(gf, gf->atomic))
+      gf->wr_sig_pending = false;
+
+    if (len < gf->rcvlowat)
+      continue;
+
+    if (gf->async_queue && !gf->rd_sig_pending) {
+      gf->rd_sig_pending = true;
+      kill_fasync(&gf->async_queue, SIGIO, POLL_IN);
+      log_debug("%s kill SIGIO\n", __func__);
+    }
+
+    if (gf->rd_eventfd)
+      globalfifo_eventfd_signal(gf->rd_eventfd);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_notify_writers
+* Description: asynchronous notification that space was freed
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex, current_len is sampled once like in
+*              globalfifo_notify_readers(). Every open file whose sndlowat is free gets
+*              a POLL_OUT signal if it enabled FASYNC and an eventfd count if it registered
+*              a write eventfd. Signals are coalesced like in globalfifo_notify_readers().
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Send POLL_OUT signals when space is freed
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Wait for room for one atomic write
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Sample current_len once, it changes without dev->mutex
+
+********************************************************************************************/
+static void globalfifo_notify_writers(struct globalfifo_dev * dev)
+{
+  struct globalfifo_file * gf;
+  unsigned int len = READ_ONCE(dev->current_len);
+
+  list_for_each_entry(gf, &dev->files, list) {
+    if (len < gf->rcvlowat)
+      gf->rd_sig_pending = false;
+
+    if (GLOBALFIFO_SIZE - len < globalfifo_write_need(gf, gf->atomic))
+      continue;
+
+    /* only files open for writing care about free space */
+    if (gf->async_queue && (gf->mode & FMODE_WRITE) && !gf->wr_sig_pending) {
+      gf->wr_sig_pending = true;
+      kill_fasync(&gf->async_queue, SIGIO, POLL_OUT);
+      log_debug("%s kill SIGIO\n", __func__);
+    }
+
+    if (gf->wr_eventfd)
+      globalfifo_eventfd_signal(gf->wr_eventfd);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_update_notify
+* Description: count or uncount an open file in dev->notify_files
+* Input:       gf: per file state
+* Output:      None
+* Return:      None
+* Others:      caller must hold dev->mutex. A file is counted while it has FASYNC on or
+*              an eventfd registered, a newly counted file starts with no signal pending.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_update_notify(struct globalfifo_file * gf)
+{
+  struct globalfifo_dev * dev = gf->dev;
+  bool notify = gf->async_queue || gf->rd_eventfd || gf->wr_eventfd;
+
+  if (notify == gf->notify)
+    return;
+
+  gf->notify = notify;
+  if (notify) {
+    gf->rd_sig_pending = false;
+    gf->wr_sig_pending = false;
+    WRITE_ONCE(dev->notify_files, dev->notify_files + 1);
+  } else {
+    WRITE_ONCE(dev->notify_files, dev->notify_files - 1);
+  }
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_set_eventfd
+* Description: register or drop the eventfd of an open file
+* Input:       gf: per file state
+*              cmd: FIFO_SET_RD_EVENTFD_CMD or FIFO_SET_WR_EVENTFD_CMD
+*              fd: eventfd descriptor, negative to drop the registration
+* Output:      None
+* Return:      0: execute success
+*              other: fd is not an eventfd
+* Others:      the eventfd is signalled right away when the condition already holds,
+*              so an edge-triggered event loop does not miss data queued before
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Wait for room for one atomic write
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Keep dev->notify_files up to date
+
+********************************************************************************************/
+static int globalfifo_set_eventfd(struct globalfifo_file * gf, unsigned int cmd, int fd)
+{
+  struct eventfd_ctx * ctx = NULL;
+  struct eventfd_ctx * old;
+  struct globalfifo_dev * dev = gf->dev;
+
+  if (fd >= 0) {
+    ctx = eventfd_ctx_fdget(fd);
+    if (IS_ERR(ctx))
+      return PTR_ERR(ctx);
+  }
+
+  mutex_lock(&dev->mutex);
+  if (cmd == FIFO_SET_RD_EVENTFD_CMD) {
+    old = gf->rd_eventfd;
+    gf->rd_eventfd = ctx;
+    if (ctx && READ_ONCE(dev->current_len) >= gf->rcvlowat)
+      globalfifo_eventfd_signal(ctx);
+  } else {
+    old = gf->wr_eventfd;
+    gf->wr_eventfd = ctx;
+    if (ctx && GLOBALFIFO_SIZE - READ_ONCE(dev->current_len) >= globalfifo_write_need(gf, gf->atomic))
+      globalfifo_eventfd_signal(ctx);
+  }
+  globalfifo_update_notify(gf);
+  mutex_unlock(&dev->mutex);
+
+  if (old)
+    eventfd_ctx_put(old);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_stats_show
+* Description: print the blocking and occupancy counters
+* Input:       s: seq file of /sys/kernel/debug/globalfifo/stats
+*              unused: seq iterator, not used
+* Output:      None
+* Return:      0: execute success
+* Others:      the counters are copied under both side mutexes so one snapshot is consistent
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Show the busy poll counters
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Snapshot under rd_mutex and wr_mutex
+
+********************************************************************************************/
+static int globalfifo_stats_show(struct seq_file * s, void * unused)
+{
+  struct globalfifo_dev * dev = s->private;
+  struct globalfifo_stats st;
+  unsigned int len;
+
+  mutex_lock(&dev->rd_mutex);
+  mutex_lock(&dev->wr_mutex);
+  st = dev->stats;
+  len = READ_ONCE(dev->current_len);
+  mutex_unlock(&dev->wr_mutex);
+  mutex_unlock(&dev->rd_mutex);
+
+  seq_printf(s, "size:        %u\n", GLOBALFIFO_SIZE);
+  seq_printf(s, "current_len: %u\n", len);
+  seq_printf(s, "max_len:     %u\n", st.max_len);
+  seq_printf(s, "rd_bytes:    %llu\n", st.rd_bytes);
+  seq_printf(s, "rd_sleeps:   %llu\n", st.rd_sleeps);
+  seq_printf(s, "rd_sleep_ns: %llu\n", st.rd_sleep_ns);
+  seq_printf(s, "rd_eagain:   %llu\n", st.rd_eagain);
+  seq_printf(s, "rd_busy_polls: %llu\n", st.rd_busy_polls);
+  seq_printf(s, "rd_busy_hits:  %llu\n", st.rd_busy_hits);
+  seq_printf(s, "wr_bytes:    %llu\n", st.wr_bytes);
+  seq_printf(s, "wr_sleeps:   %llu\n", st.wr_sleeps);
+  seq_printf(s, "wr_sleep_ns: %llu\n", st.wr_sleep_ns);
+  seq_printf(s, "wr_eagain:   %llu\n", st.wr_eagain);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_stats_reset
+* Description: clear the counters, any value written to debugfs reset does it
+* Input:       data: globalfifo device
+*              val: written value, ignored
+* Output:      None
+* Return:      0: execute success
+* Others:      max_len restarts from the current occupancy
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Reset under rd_mutex and wr_mutex
+
+********************************************************************************************/
+static int globalfifo_stats_reset(void * data, u64 val)
+{
+  struct globalfifo_dev * dev = data;
+
+  mutex_lock(&dev->rd_mutex);
+  mutex_lock(&dev->wr_mutex);
+  memset(&dev->stats, 0, sizeof(dev->stats));
+  dev->stats.max_len = READ_ONCE(dev->current_len);
+  mutex_unlock(&dev->wr_mutex);
+  mutex_unlock(&dev->rd_mutex);
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write_need
+* Description: free space a write of this file has to wait for
+* Input:       gf: per file state
+*              size: write data size
+* Output:      None
+* Return:      unsigned int: free bytes needed
+* Others:      lockless. A write of at most gf->atomic bytes waits until it fits entirely,
+*              any other write only until sndlowat bytes are free.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static unsigned int globalfifo_write_need(struct globalfifo_file * gf, size_t size)
+{
+  unsigned int need = READ_ONCE(gf->sndlowat);
+
+  if (size <= READ_ONCE(gf->atomic))
+    need = max_t(unsigned int, need, size);
+
+  return need;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_busy_wait
+* Description: spin until the fifo holds rcvlowat bytes for this file or the busy poll
+*              budget of the file runs out
+* Input:       gf: per file state of the reader
+* Output:      None
+* Return:      true: the data arrived while spinning
+*              false: the budget ran out, the cpu is wanted elsewhere or a signal is pending
+* Others:      caller must not hold dev->rd_mutex so other readers can get in. Like busy_read on
+*              sockets this trades cpu time for the latency of a sleep and a wakeup.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static bool globalfifo_busy_wait(struct globalfifo_file * gf)
+{
+  u64 end = local_clock() + (u64)READ_ONCE(gf->busy_poll) * NSEC_PER_USEC;
+
+  do {
+    if (READ_ONCE(gf->dev->current_len) >= READ_ONCE(gf->rcvlowat))
+      return true;
+
+    if (signal_pending(current))
+      return false;
+
+    cpu_relax();
+  } while (!need_resched() && local_clock() < end);
+
+  return false;
+}
+
+
 /*
   ** module declaration
 */
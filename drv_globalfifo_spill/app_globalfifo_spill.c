@@ -0,0 +1,127 @@
+/*
+  ** @file           : app_globalfifo_spill.c
+  ** @brief          : global fifo shmem spill application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   CHUNK_SIZE                  (4096)
+#define   DEFAULT_MB                  (8)
+
+
+/********************************************************************************************
+* Function:    pattern
+* Description: byte expected at a stream offset
+* Input:       pos: offset in the byte stream
+* Output:      None
+* Return:      unsigned char: the byte
+* Others:      251 is prime so the pattern never lines up with page or ring sizes
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static unsigned char pattern(long long pos)
+{
+  return pos % 251;
+}
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list, argv[1] is the MiB to queue, 8 by default
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      queues far more than the 4 KiB ring without a reader, then reads it all
+*              back and checks that the order survived the spill
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+int main(int argc, char * argv[])
+{
+    int fd, i;
+    ssize_t len;
+    long long total, pos = 0, want;
+    unsigned char buf[CHUNK_SIZE];
+
+    want = (argc > 1 ? atoll(argv[1]) : DEFAULT_MB) << 20;
+
+    fd = open("/dev/globalfifo", O_RDWR | O_NONBLOCK);
+    if (-1 == fd) {
+        log_debug("/dev/globalfifo open failure\r\n");
+        return -1;
+    }
+
+    while (pos < want) {
+        for (i = 0; i < CHUNK_SIZE; i++)
+            buf[i] = pattern(pos + i);
+
+        len = write(fd, buf, CHUNK_SIZE);
+        if (len < 0) {
+            if (EAGAIN == errno)
+                break;
+            perror("write()");
+            return -1;
+        }
+        pos += len;
+    }
+
+    total = pos;
+    log_debug("queued %lld bytes, see spill_len in /sys/kernel/debug/globalfifo/stats\n", total);
+
+    for (pos = 0; pos < total; pos += len) {
+        len = read(fd, buf, CHUNK_SIZE);
+        if (len <= 0) {
+            perror("read()");
+            return -1;
+        }
+
+        for (i = 0; i < len; i++) {
+            if (buf[i] != pattern(pos + i)) {
+                log_debug("mismatch at %lld\n", pos + i);
+                return -1;
+            }
+        }
+    }
+
+    log_debug("read back %lld bytes in order\n", pos);
+    close(fd);
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
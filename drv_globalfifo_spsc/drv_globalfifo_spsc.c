@@ -0,0 +1,868 @@
+/*
+  ** @file           : drv_globalfifo_spsc.c
+  ** @brief          : global fifo single-producer/single-consumer driver source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/cdev.h>
+#include <linux/kern_levels.h>
+#include <linux/printk.h>
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/sched/signal.h>
+#include <linux/memory.h>
+#include <linux/poll.h>
+#include <linux/atomic.h>
+
+
+/*
+  ** define
+*/
+#define     GLOBALFIFO_SIZE         (0x1000)
+#define     GLOBALFIFO_MASK         (GLOBALFIFO_SIZE - 1)
+#define     MEM_CLEAR_CMD           (0x1)
+#define     GLOBALFIFO_MAJOR        (230)
+
+#define     log_debug(fmt, ...)     printk(KERN_DEBUG   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_info(fmt, ...)      printk(KERN_INFO    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_notice(fmt, ...)    printk(KERN_NOTICE  pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_warning(fmt, ...)   printk(KERN_WARNING pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_err(fmt, ...)       printk(KERN_ERR     pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_crit(fmt, ...)      printk(KERN_CRIT    pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_alert(fmt, ...)     printk(KERN_ALERT   pr_fmt(fmt), ##__VA_ARGS__)
+#define     log_emerg(fmt, ...)     printk(KERN_EMERG   pr_fmt(fmt), ##__VA_ARGS__)
+
+
+/*
+  ** struct
+*/
+/*
+  ** head and tail are free-running byte counters, the fill level is tail - head and
+  ** the position inside mem[] is the counter masked with GLOBALFIFO_MASK. In spsc mode
+  ** tail is only written by the producer and head only by the consumer.
+  ** rd_mutex/wr_mutex serialize the callers of globalfifo_spsc_read()/globalfifo_spsc_write(),
+  ** the open counts alone do not stop threads, a fork or a passed fd from sharing one
+  ** file. Each side only ever takes its own mutex, so the producer and the consumer
+  ** still never wait for each other.
+*/
+struct globalfifo_dev {
+  struct cdev cdev;
+  unsigned int head;
+  unsigned int tail;
+  atomic_t readers;
+  atomic_t writers;
+  unsigned char mem[GLOBALFIFO_SIZE];
+  struct mutex mutex;
+  struct mutex rd_mutex;
+  struct mutex wr_mutex;
+  wait_queue_head_t r_wait;
+  wait_queue_head_t w_wait;
+  struct fasync_struct * async_queue;
+};
+
+
+/*
+  ** static function declaration
+*/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos);
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos);
+static ssize_t globalfifo_spsc_read(struct file * filp, char __user * buf, size_t size);
+static ssize_t globalfifo_spsc_write(struct file * filp, const char __user * buf, size_t size);
+static unsigned int globalfifo_len(struct globalfifo_dev * dev);
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig);
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg);
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait);
+static int globalfifo_open(struct inode * inode, struct file * filp);
+static int globalfifo_release(struct inode * inode, struct file *filp);
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index);
+static int globalfifo_ring_copy_out(struct globalfifo_dev * dev, char __user * buf, unsigned int head, unsigned int size);
+static int globalfifo_ring_copy_in(struct globalfifo_dev * dev, const char __user * buf, unsigned int tail, unsigned int size);
+static int globalfifo_fasync(int fd, struct file * filp, int mode);
+
+
+/*
+  ** global variable
+*/
+static const struct file_operations globalfifo_fops = {
+  .owner = THIS_MODULE,
+  .llseek = globalfifo_llseek,
+  .read = globalfifo_read,
+  .write = globalfifo_write,
+  .unlocked_ioctl = globalfifo_ioctl,
+  .poll = globalfifo_poll,
+  .fasync = globalfifo_fasync,
+  .open = globalfifo_open,
+  .release = globalfifo_release,
+};
+
+
+/*
+  ** static global variable
+*/
+static int globalfifo_major = GLOBALFIFO_MAJOR;
+module_param(globalfifo_major, int, S_IRUGO);
+
+static bool globalfifo_spsc = true;
+module_param(globalfifo_spsc, bool, S_IRUGO);
+
+struct globalfifo_dev * globalfifo_devp;
+
+
+/* 
+  ** static function list
+*/
+
+/********************************************************************************************
+* Function:    globalfifo_read
+* Description: globalfifo read data
+* Input:       filp: struct file
+*              size: read data size
+*              ppos: pos offset
+* Output:      buf: read buffer
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Read from the ring head instead of shifting the buffer
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Dispatch to the lock-free path in spsc mode
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Return -EBUSY to a second concurrent spsc reader
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Let a second concurrent spsc reader wait on rd_mutex instead of failing
+
+********************************************************************************************/
+static ssize_t globalfifo_read(struct file * filp, char __user * buf, size_t size, loff_t * ppos)
+{
+  int ret = 0;
+  struct globalfifo_dev *dev = filp->private_data;
+
+  DECLARE_WAITQUEUE(wait, current);
+
+  if (globalfifo_spsc) {
+    if (filp->f_flags & O_NONBLOCK) {
+      if (!mutex_trylock(&dev->rd_mutex))
+        return -EAGAIN;
+    } else if (mutex_lock_interruptible(&dev->rd_mutex)) {
+      return -ERESTARTSYS;
+    }
+
+    ret = globalfifo_spsc_read(filp, buf, size);
+    mutex_unlock(&dev->rd_mutex);
+    return ret;
+  }
+
+  mutex_lock(&dev->mutex);
+  add_wait_queue(&dev->r_wait, &wait);
+
+  while(globalfifo_len(dev) == 0) {
+    if (filp->f_flags & O_NONBLOCK) {
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    __set_current_state(TASK_INTERRUPTIBLE);
+    mutex_unlock(&dev->mutex);
+
+    schedule();
+    if(signal_pending(current)) {
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+  }
+
+  if (size > globalfifo_len(dev))
+    size = globalfifo_len(dev);
+
+  if (globalfifo_ring_copy_out(dev, buf, dev->head, size)) {
+    ret = -EFAULT;
+    goto out;
+  } else {
+    dev->head += size;
+    log_debug("read %d bytes(s), current_len:%d\n", size, globalfifo_len(dev));
+
+    wake_up_interruptible(&dev->w_wait);
+    ret = size;
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+
+out2:
+  remove_wait_queue(&dev->r_wait, &wait);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_write
+* Description: globalfifo write data
+* Input:       filp: struct file
+*              buf: write buffer
+*              size: write data size
+*              ppos: pos offset
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Append at the ring tail with wrap-around
+             3.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Dispatch to the lock-free path in spsc mode
+             4.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Return -EBUSY to a second concurrent spsc writer
+             5.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Let a second concurrent spsc writer wait on wr_mutex instead of failing
+
+********************************************************************************************/
+static ssize_t globalfifo_write(struct file * filp, const char __user * buf, size_t size, loff_t * ppos)
+{
+  int ret = 0;
+  struct globalfifo_dev * dev = filp->private_data;
+
+  DECLARE_WAITQUEUE(wait, current);
+
+  if (globalfifo_spsc) {
+    if (filp->f_flags & O_NONBLOCK) {
+      if (!mutex_trylock(&dev->wr_mutex))
+        return -EAGAIN;
+    } else if (mutex_lock_interruptible(&dev->wr_mutex)) {
+      return -ERESTARTSYS;
+    }
+
+    ret = globalfifo_spsc_write(filp, buf, size);
+    mutex_unlock(&dev->wr_mutex);
+    return ret;
+  }
+
+  mutex_lock(&dev->mutex);
+  add_wait_queue(&dev->w_wait, &wait);
+
+  while(globalfifo_len(dev) == GLOBALFIFO_SIZE) {
+    if (filp->f_flags & O_NONBLOCK) {
+      ret = -EAGAIN;
+      goto out;
+    }
+
+    __set_current_state(TASK_INTERRUPTIBLE);
+
+    mutex_unlock(&dev->mutex);
+    schedule();
+
+    if (signal_pending(current)) {
+      ret = -ERESTARTSYS;
+      goto out2;
+    }
+
+    mutex_lock(&dev->mutex);
+  }
+
+  if (size >= GLOBALFIFO_SIZE - globalfifo_len(dev))
+    size = GLOBALFIFO_SIZE - globalfifo_len(dev);
+
+  if (globalfifo_ring_copy_in(dev, buf, dev->tail, size)) {
+    ret = -EFAULT;
+    goto out;
+  } else {
+    dev->tail += size;
+    log_debug("written %u bytes(s), current_len:%d\n", size, globalfifo_len(dev));
+
+    wake_up_interruptible(&dev->r_wait);
+
+    if (dev->async_queue) {
+      kill_fasync(&dev->async_queue, SIGIO, POLL_IN);
+      log_debug("%s kill SIGIO\n", __func__);
+    }
+
+    ret = size;
+  }
+
+out:
+  mutex_unlock(&dev->mutex);
+out2:
+  remove_wait_queue(&dev->w_wait, &wait);
+  set_current_state(TASK_RUNNING);
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_llseek
+* Description: globalfifo llseek pos
+* Input:       filp: struct file
+*              offset: pos offse
+*              orig: pos flag
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static loff_t globalfifo_llseek(struct file * filp, loff_t offset, int orig)
+{
+  loff_t ret = 0;
+  switch (orig) {
+  case 0:
+    if (offset < 0) {
+      ret = -EINVAL;
+      break;
+    }
+
+    if((unsigned int)offset > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }
+
+    filp->f_pos = (unsigned int)offset;
+    ret = filp->f_pos;
+    break;
+  case 1:
+    if ((filp->f_pos + offset) > GLOBALFIFO_SIZE) {
+      ret = -EINVAL;
+      break;
+    }  
+
+    if ((filp->f_pos + offset) < 0) {
+      ret = -EINVAL;
+      break;
+    }
+    filp->f_pos += offset;
+    ret = filp->f_pos;
+    break;
+
+  default:
+    ret = -EINVAL;
+    break;
+
+  }
+
+  return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ioctl
+* Description: globalfifo ioctl
+* Input:       filp: struct file
+*              cmd: command
+*              arg: argue
+* Output:      None
+* Return:      ssize_t: read data count
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static long globalfifo_ioctl(struct file * filp, unsigned int cmd, unsigned long arg)
+{
+  struct globalfifo_dev * dev = filp->private_data;
+
+  switch (cmd)
+  {
+  case MEM_CLEAR_CMD:
+    memset(dev->mem, 0, GLOBALFIFO_SIZE);
+    log_debug("globalfifo is set to zero\n");
+    break;
+  
+  default:
+    return -EINVAL;
+    break;
+  }
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_poll
+* Description: globalfifo poll
+* Input:       filp: struct file
+*              poll_table: poll table pointer
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Compute the mask from a lockless snapshot of the indices
+
+********************************************************************************************/
+static unsigned int globalfifo_poll(struct file * filp, poll_table * wait)
+{
+  unsigned int mask = 0;
+  unsigned int len;
+  struct globalfifo_dev * dev = filp->private_data;
+
+  poll_wait(filp, &dev->r_wait, wait);
+  poll_wait(filp, &dev->w_wait, wait);
+
+  /* 
+    ** a snapshot is enough here, the poll core re-checks after every wakeup, and
+    ** in spsc mode the indices are never updated under dev->mutex anyway
+  */
+  len = globalfifo_len(dev);
+
+  if (len != 0) {
+    mask |= POLLIN | POLLRDNORM;
+  }
+  
+  if (len != GLOBALFIFO_SIZE) {
+    mask |= POLLOUT | POLLWRNORM;
+  }
+
+  return mask;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_fasync
+* Description: globalfifo fasync
+* Input:       fd: file descriptor 
+*              filp: struct file
+*              mode: file mode
+* Output:      None
+* Return:      unsigned int: function mask
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_fasync(int fd, struct file * filp, int mode)
+{
+  struct globalfifo_dev * dev = filp->private_data;
+
+  return fasync_helper(fd, filp, mode, &dev->async_queue);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_open
+* Description: globalfifo open
+* Input:       inode: inode 
+* Output:      filp: strcut file
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Allow only one reader and one writer in spsc mode
+
+********************************************************************************************/
+static int globalfifo_open(struct inode * inode, struct file * filp)
+{
+  struct globalfifo_dev * dev = globalfifo_devp;
+
+  if (globalfifo_spsc) {
+    if ((filp->f_mode & FMODE_READ) && atomic_inc_return(&dev->readers) > 1) {
+      atomic_dec(&dev->readers);
+      return -EBUSY;
+    }
+
+    if ((filp->f_mode & FMODE_WRITE) && atomic_inc_return(&dev->writers) > 1) {
+      atomic_dec(&dev->writers);
+      if (filp->f_mode & FMODE_READ)
+        atomic_dec(&dev->readers);
+      return -EBUSY;
+    }
+  }
+
+  filp->private_data = dev;
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_release
+* Description: globalfifo relesase
+* Input:       inode: inode 
+*              filp: strcut file
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Drop the spsc reader/writer reference
+
+********************************************************************************************/
+static int globalfifo_release(struct inode * inode, struct file *filp)
+{
+  struct globalfifo_dev * dev = filp->private_data;
+
+  globalfifo_fasync(-1, filp, 0);
+
+  if (globalfifo_spsc) {
+    if (filp->f_mode & FMODE_READ)
+      atomic_dec(&dev->readers);
+    if (filp->f_mode & FMODE_WRITE)
+      atomic_dec(&dev->writers);
+  }
+  
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_init
+* Description: globalfifo initial
+* Input:       Noen
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+             2.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Initialize rd_mutex and wr_mutex
+
+********************************************************************************************/
+static int __init globalfifo_init(void)
+{
+    int ret;
+
+    dev_t devno = MKDEV(globalfifo_major, 0);
+    
+    if (globalfifo_major) 
+      ret = register_chrdev_region(devno, 1, "globalfifo");
+    else {
+      ret = alloc_chrdev_region(&devno, 0, 1, "globalfifo");
+      globalfifo_major = MAJOR(devno);
+    }
+
+    if (ret < 0) 
+      return ret;
+
+    globalfifo_devp = kzalloc(sizeof(struct globalfifo_dev), GFP_KERNEL);
+    if (!globalfifo_devp) {
+      ret = -ENOMEM;
+      goto fail_malloc;
+    }
+
+    globalfifo_setup_cdev(globalfifo_devp, 0);
+    mutex_init(&globalfifo_devp->mutex);
+    mutex_init(&globalfifo_devp->rd_mutex);
+    mutex_init(&globalfifo_devp->wr_mutex);
+    init_waitqueue_head(&globalfifo_devp->r_wait);
+    init_waitqueue_head(&globalfifo_devp->w_wait);
+
+    return 0; 
+
+fail_malloc:
+    unregister_chrdev_region(devno, 1);
+    return ret;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_exit
+* Description: globalfifo exit
+* Input:       Noen
+* Output:      None
+* Return:      None
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void __exit globalfifo_exit(void)
+{
+    cdev_del(&globalfifo_devp->cdev);
+    kfree(globalfifo_devp);
+    unregister_chrdev_region(MKDEV(globalfifo_major, 0), 1);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_setup_cdev
+* Description: globalfifo setup cdev struct 
+* Input:       index: cdev index node
+* Output:      dev: initialed cdev 
+* Return:      None
+* Others:      
+* Revision history:
+             1.Date:     2022-1-24
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static void globalfifo_setup_cdev(struct globalfifo_dev * dev, int index)
+{
+  int err, devno = MKDEV(globalfifo_major, index);
+
+  cdev_init(&dev->cdev, &globalfifo_fops);
+  dev->cdev.owner = THIS_MODULE;
+
+  err = cdev_add(&dev->cdev, devno, 1);
+  if (err) 
+    log_debug("Error %d adding globalfifo%d", err, index);
+
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_spsc_read
+* Description: globalfifo lock-free read for the single consumer
+* Input:       filp: struct file
+*              size: read data size
+* Output:      buf: read buffer
+* Return:      ssize_t: read data count
+* Others:      the tail published by the producer is loaded with acquire semantics so the
+*              data behind it is visible, the new head is published with release semantics
+*              once the data has been copied out. dev->mutex is never taken, the reader
+*              only touches r_wait when the fifo is empty and it has to sleep.
+*              Caller must hold dev->rd_mutex, a second concurrent read of the same
+*              file waits for it instead of racing on head.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static ssize_t globalfifo_spsc_read(struct file * filp, char __user * buf, size_t size)
+{
+  int ret;
+  unsigned int head, tail;
+  struct globalfifo_dev * dev = filp->private_data;
+
+  head = dev->head;
+  tail = smp_load_acquire(&dev->tail);
+
+  if (tail == head) {
+    if (filp->f_flags & O_NONBLOCK)
+      return -EAGAIN;
+
+    ret = wait_event_interruptible(dev->r_wait,
+                                   (tail = smp_load_acquire(&dev->tail)) != head);
+    if (ret)
+      return -ERESTARTSYS;
+  }
+
+  if (size > tail - head)
+    size = tail - head;
+
+  if (globalfifo_ring_copy_out(dev, buf, head, size))
+    return -EFAULT;
+
+  smp_store_release(&dev->head, head + size);
+
+  /* wq_has_sleeper() pairs with the barrier in prepare_to_wait() of the writer */
+  if (wq_has_sleeper(&dev->w_wait))
+    wake_up_interruptible(&dev->w_wait);
+
+  return size;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_spsc_write
+* Description: globalfifo lock-free write for the single producer
+* Input:       filp: struct file
+*              buf: write buffer
+*              size: write data size
+* Output:      None
+* Return:      ssize_t: written data count
+* Others:      mirror of globalfifo_spsc_read(), the head published by the consumer is
+*              loaded with acquire semantics and the new tail is published with release
+*              semantics after the data has been copied in. Caller must hold
+*              dev->wr_mutex.
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static ssize_t globalfifo_spsc_write(struct file * filp, const char __user * buf, size_t size)
+{
+  int ret;
+  unsigned int head, tail;
+  struct globalfifo_dev * dev = filp->private_data;
+
+  tail = dev->tail;
+  head = smp_load_acquire(&dev->head);
+
+  if (tail - head == GLOBALFIFO_SIZE) {
+    if (filp->f_flags & O_NONBLOCK)
+      return -EAGAIN;
+
+    ret = wait_event_interruptible(dev->w_wait,
+                                   tail - (head = smp_load_acquire(&dev->head)) != GLOBALFIFO_SIZE);
+    if (ret)
+      return -ERESTARTSYS;
+  }
+
+  if (size > GLOBALFIFO_SIZE - (tail - head))
+    size = GLOBALFIFO_SIZE - (tail - head);
+
+  if (globalfifo_ring_copy_in(dev, buf, tail, size))
+    return -EFAULT;
+
+  smp_store_release(&dev->tail, tail + size);
+
+  if (wq_has_sleeper(&dev->r_wait))
+    wake_up_interruptible(&dev->r_wait);
+
+  if (dev->async_queue)
+    kill_fasync(&dev->async_queue, SIGIO, POLL_IN);
+
+  return size;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_len
+* Description: globalfifo fill level
+* Input:       dev: globalfifo device
+* Output:      None
+* Return:      unsigned int: bytes currently buffered
+* Others:      lockless snapshot, callers that need a stable value must hold dev->mutex
+*              (mutex mode) or be the only producer/consumer (spsc mode)
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static unsigned int globalfifo_len(struct globalfifo_dev * dev)
+{
+  return READ_ONCE(dev->tail) - READ_ONCE(dev->head);
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_copy_out
+* Description: copy data out of the ring to user space starting at the given head,
+*              the data may wrap around the end of mem[] so it is copied in two segments
+* Input:       dev: globalfifo device
+*              head: free-running read counter
+*              size: read data size, must not exceed the fill level
+* Output:      buf: read buffer
+* Return:      0: execute success
+*              -EFAULT: copy to user failure
+* Others:      the caller advances dev->head
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_ring_copy_out(struct globalfifo_dev * dev, char __user * buf, unsigned int head, unsigned int size)
+{
+  unsigned int off = head & GLOBALFIFO_MASK;
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - off);
+
+  if (copy_to_user(buf, dev->mem + off, first))
+    return -EFAULT;
+
+  if (copy_to_user(buf + first, dev->mem, size - first))
+    return -EFAULT;
+
+  return 0;
+}
+
+
+/********************************************************************************************
+* Function:    globalfifo_ring_copy_in
+* Description: copy data from user space into the ring starting at the given tail,
+*              the free space may wrap around the end of mem[] so it is filled in two segments
+* Input:       dev: globalfifo device
+*              buf: write buffer
+*              tail: free-running write counter
+*              size: write data size, must not exceed the free space
+* Output:      None
+* Return:      0: execute success
+*              -EFAULT: copy from user failure
+* Others:      the caller advances dev->tail
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+static int globalfifo_ring_copy_in(struct globalfifo_dev * dev, const char __user * buf, unsigned int tail, unsigned int size)
+{
+  unsigned int off = tail & GLOBALFIFO_MASK;
+  unsigned int first = min_t(unsigned int, size, GLOBALFIFO_SIZE - off);
+
+  if (copy_from_user(dev->mem + off, buf, first))
+    return -EFAULT;
+
+  if (copy_from_user(dev->mem, buf + first, size - first))
+    return -EFAULT;
+
+  return 0;
+}
+
+
+/*
+  ** module declaration
+*/
+module_init(globalfifo_init);
+module_exit(globalfifo_exit);
+
+MODULE_AUTHOR("JexJiang");
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("A simple Hello World Module");
+MODULE_ALIAS("a simplest module");
+MODULE_VERSION("v1.0");
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/
@@ -0,0 +1,87 @@
+/*
+  ** @file           : app_globalfifo_tstamp.c
+  ** @brief          : global fifo timestamp application source file
+  **
+  ** @attention
+  **
+  ** Copyright (c) 2022 ShangHaiHeQian.
+  ** All rights reserved.
+  **
+  ** This software is licensed by ShangHaiHeQian under Ultimate Liberty license
+  **
+*/
+
+
+/*
+  ** include
+*/
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/*
+  ** define
+*/
+#define   log_debug(fmt, ...)         printf("file:%s, function:%s, line:%d: "fmt"", __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define   FIFO_GET_TSTAMP_CMD         (0x6)
+#define   BUFFER_SIZE                 (64)
+
+
+/********************************************************************************************
+* Function:    main
+* Description: main function
+* Input:       argc: arg count
+*              argv: arg list
+* Output:      None
+* Return:      0: execute success
+*              other: execute failure
+* Others:      prints how long the first byte of every read waited in the fifo,
+*              feed it with: echo hello > /dev/globalfifo
+*              the histogram is in /sys/kernel/debug/globalfifo/latency
+* Revision history:
+             1.Date:     2026-10-17
+               Author:   JexJiang
+               Modification: Function created
+
+********************************************************************************************/
+int main(int argc, char * argv[])
+{
+    int fd;
+    ssize_t len;
+    uint64_t stamp, now;
+    struct timespec ts;
+    char buf[BUFFER_SIZE];
+
+    fd = open("/dev/globalfifo", O_RDONLY);
+    if (-1 == fd) {
+        log_debug("/dev/globalfifo open failure\r\n");
+        return -1;
+    }
+
+    while (1) {
+        len = read(fd, buf, sizeof(buf) - 1);
+        if (len <= 0)
+            continue;
+
+        /* the driver stamps with ktime_get_ns(), which is CLOCK_MONOTONIC */
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        now = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+        ioctl(fd, FIFO_GET_TSTAMP_CMD, &stamp);
+
+        buf[len] = '\0';
+        log_debug("waited %llu ns: %s", (unsigned long long)(now - stamp), buf);
+    }
+
+    return 0;
+}
+
+
+/*
+  ** (C) COPYRIGHT ShangHaiHeQian END OF FILE
+*/